@@ -2,6 +2,15 @@
 #include <cmath>
 #include <gmpxx.h>
 #include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
@@ -11,58 +20,635 @@ using namespace std;
   j(tau) = 1/q + 744 + sum_{n=1}^∞ c(n) q^n
   where q = exp(2πiτ)
 
-  At τ = i√163:
-  q = exp(-2π√163) ≈ 2.6 × 10⁻¹⁸
+  At τ = (1 + i√163)/2, where j = -640320³ exactly:
+  q = -exp(-π√163) ≈ -3.8 × 10⁻¹⁸
 
+  so e^{π√163} = 640320³ + 744 - 196884 e^{-π√163} - ...
   This explains the near-integer phenomenon.
 */
 
-// Known integer Fourier coefficients (first few)
-const long long C[] = {
-    196884,
-    21493760,
-    864299970,
-    20245856256,
-    333202640600
+/*
+  Coefficient engine
+
+  With P(q) = prod_{n>=1} (1 - q^n)^24, so that Delta = q P,
+
+      j(tau) q = E4(q)^3 / P(q),   E4 = 1 + 240 sum sigma_3(n) q^n,
+
+  and c(n) is the coefficient of q^{n+1} on the right. sigma_3
+  comes from a divisor sieve. P = (eta^3 / q^{1/8})^8 starts from
+  Jacobi's sparse series prod (1 - q^n)^3 = sum (-1)^k (2k+1)
+  q^{k(k+1)/2} and takes three squarings; 1/P is formed by Newton
+  iteration. All of this runs modulo 62-bit primes p = c 2^22 + 1,
+  with NTT products in Montgomery arithmetic, one prime per
+  thread task.
+
+  Since c(n) < e^{4 pi sqrt(n)}, coefficient n needs only the
+  first bits(n)/61 + 1 primes; residues are kept just for the
+  coefficients that use them, and Garner's mixed-radix CRT
+  rebuilds each c(n) as a GMP integer. Memory grows like the
+  output itself, about N^{3/2} bits (1.5 GB at N = 10^6).
+*/
+using u64 = uint64_t;
+using u128 = unsigned __int128;
+
+const int NTT_LOG_MAX = 22;                 // transform length limit 2^22
+const size_t J_MAX_TERMS = size_t(1) << (NTT_LOG_MAX - 1);
+
+// Arithmetic modulo an odd p < 2^62, values kept as a 2^64 mod p
+struct Montgomery {
+    u64 p, p_neg_inv, r2;                   // -p^{-1} mod 2^64, 2^128 mod p
+
+    explicit Montgomery(u64 modulus) : p(modulus) {
+        u64 inv = p;                        // Newton: correct bits double each step
+        for (int i = 0; i < 6; ++i) inv *= 2 - p * inv;
+        p_neg_inv = ~inv + 1;
+        u128 r = (u128(1) << 64) % p;
+        r2 = u64((r * r) % p);
+    }
+
+    u64 reduce(u128 t) const {
+        u64 m = u64(t) * p_neg_inv;
+        u64 r = u64((t + u128(m) * p) >> 64);
+        return r >= p ? r - p : r;
+    }
+    u64 mul(u64 a, u64 b) const { return reduce(u128(a) * b); }
+    u64 to(u64 a) const { return mul(a % p, r2); }
+    u64 from(u64 a) const { return reduce(a); }
+    u64 add(u64 a, u64 b) const { u64 s = a + b; return s >= p ? s - p : s; }
+    u64 sub(u64 a, u64 b) const { return a >= b ? a - b : a + p - b; }
+
+    u64 pow(u64 a, u64 e) const {
+        u64 result = to(1);
+        for (; e; e >>= 1, a = mul(a, a))
+            if (e & 1) result = mul(result, a);
+        return result;
+    }
 };
 
-mpz_class compute_exact_core() {
-    mpz_class base("640320");
-    mpz_class cube = base * base * base;
-    return -cube;
+// Deterministic for 64-bit n with these bases
+bool is_prime_u64(u64 n) {
+    if (n < 2) return false;
+    for (u64 p : { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 })
+        if (n % p == 0) return n == p;
+    u64 d = n - 1;
+    int s = 0;
+    for (; d % 2 == 0; d /= 2) ++s;
+    auto mulmod = [n](u64 a, u64 b) { return u64(u128(a) * b % n); };
+    for (u64 a : { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 }) {
+        u64 x = 1, base = a, e = d;
+        for (; e; e >>= 1, base = mulmod(base, base))
+            if (e & 1) x = mulmod(x, base);
+        if (x == 1 || x == n - 1) continue;
+        bool composite = true;
+        for (int r = 1; r < s && composite; ++r) {
+            x = mulmod(x, x);
+            if (x == n - 1) composite = false;
+        }
+        if (composite) return false;
+    }
+    return true;
+}
+
+// The first count primes below 2^62 of the form c 2^22 + 1, descending
+vector<u64> ntt_primes(size_t count) {
+    vector<u64> primes;
+    for (u64 c = ((u64(1) << 62) - 1) >> NTT_LOG_MAX; primes.size() < count; --c) {
+        u64 p = (c << NTT_LOG_MAX) + 1;
+        if (is_prime_u64(p)) primes.push_back(p);
+    }
+    return primes;
+}
+
+struct NttPrime {
+    Montgomery mont;
+    vector<u64> rt;                         // rt[k + j] = w_{2k}^j, Montgomery form
+
+    // Roots for transforms of length up to max_length
+    NttPrime(u64 p, size_t max_length) : mont(p), rt(max<size_t>(max_length, 2), mont.to(1)) {
+        // A non-residue g gives g^{(p-1)/2^22} of order exactly 2^22
+        u64 root = 0;
+        for (u64 g = 3; !root; ++g) {
+            u64 gm = mont.to(g);
+            if (mont.from(mont.pow(gm, (p - 1) / 2)) == p - 1)
+                root = mont.pow(gm, (p - 1) >> NTT_LOG_MAX);
+        }
+        for (size_t k = 2; k < max_length; k *= 2) {
+            u64 z = root;
+            for (size_t m = (size_t(1) << NTT_LOG_MAX) / (2 * k); m > 1; m /= 2) z = mont.mul(z, z);
+            for (size_t i = k / 2; i < k; ++i) {
+                rt[2 * i] = rt[i];
+                rt[2 * i + 1] = mont.mul(rt[i], z);
+            }
+        }
+    }
+
+    // In-place cyclic transform of length a.size() (a power of two)
+    void transform(vector<u64>& a, bool inverse) const {
+        const size_t n = a.size();
+        for (size_t i = 1, j = 0; i < n; ++i) {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1) j ^= bit;
+            j ^= bit;
+            if (i < j) swap(a[i], a[j]);
+        }
+
+        for (size_t k = 1; k < n; k *= 2)
+            for (size_t i = 0; i < n; i += 2 * k)
+                for (size_t j = 0; j < k; ++j) {
+                    u64 z = mont.mul(rt[j + k], a[i + j + k]);
+                    a[i + j + k] = mont.sub(a[i + j], z);
+                    a[i + j] = mont.add(a[i + j], z);
+                }
+
+        if (inverse) {
+            reverse(a.begin() + 1, a.end());
+            u64 scale = mont.pow(mont.to(n), mont.p - 2);
+            for (auto& x : a) x = mont.mul(x, scale);
+        }
+    }
+
+    // a b mod x^len
+    vector<u64> multiply(vector<u64> a, vector<u64> b, size_t len) const {
+        a.resize(min(a.size(), len));
+        b.resize(min(b.size(), len));
+        size_t n = 1;
+        while (n < a.size() + b.size()) n *= 2;
+        a.resize(n, 0);
+        b.resize(n, 0);
+        transform(a, false);
+        transform(b, false);
+        for (size_t i = 0; i < n; ++i) a[i] = mont.mul(a[i], b[i]);
+        transform(a, true);
+        a.resize(len, 0);
+        return a;
+    }
+
+    vector<u64> square(vector<u64> a, size_t len) const {
+        a.resize(min(a.size(), len));
+        size_t n = 1;
+        while (n < 2 * a.size()) n *= 2;
+        a.resize(n, 0);
+        transform(a, false);
+        for (auto& x : a) x = mont.mul(x, x);
+        transform(a, true);
+        a.resize(len, 0);
+        return a;
+    }
+
+    // 1/f mod x^len for f[0] = 1, by g <- g (2 - f g)
+    vector<u64> inverse(const vector<u64>& f, size_t len) const {
+        vector<u64> g{ mont.to(1) };
+        const u64 two = mont.to(2);
+        for (size_t k = 1; k < len; k *= 2) {
+            size_t next = min(2 * k, len);
+            size_t n = 4 * k;
+            vector<u64> F(f.begin(), f.begin() + min(f.size(), next));
+            vector<u64> G = g;
+            F.resize(n, 0);
+            G.resize(n, 0);
+            transform(F, false);
+            transform(G, false);
+            for (size_t i = 0; i < n; ++i)
+                G[i] = mont.mul(G[i], mont.sub(two, mont.mul(F[i], G[i])));
+            transform(G, true);
+            G.resize(next);
+            g.swap(G);
+        }
+        return g;
+    }
+};
+
+// sigma_3(n) for n < len; fits in 64 bits for len <= 2^21
+vector<u64> sigma3_table(size_t len) {
+    vector<u64> s(len, 0);
+    for (u64 d = 1; d < len; ++d) {
+        u64 cube = d * d * d;
+        for (u64 m = d; m < len; m += d) s[m] += cube;
+    }
+    return s;
 }
 
-void compute_j_invariant(int terms) {
-    cout << "\n[ Computing j(i√163) using Fourier expansion ]\n";
+// Coefficients of E4^3 / P mod p, q^0 .. q^{len-1}, plain residues
+vector<u64> j_series_mod(const NttPrime& ntt, const vector<u64>& sigma3, size_t len) {
+    const Montgomery& m = ntt.mont;
+
+    vector<u64> e4(len);
+    e4[0] = m.to(1);
+    const u64 c240 = m.to(240);
+    for (size_t n = 1; n < len; ++n) e4[n] = m.mul(c240, m.to(sigma3[n]));
 
-    long double sqrt163 = sqrt((long double)163.0);
-    long double q = expl(-2.0L * M_PI * sqrt163);
+    // prod (1 - q^n)^3, then three squarings
+    vector<u64> p(len, 0);
+    for (u64 k = 0; k * (k + 1) / 2 < len; ++k) {
+        u64 v = m.to(2 * k + 1);
+        p[k * (k + 1) / 2] = (k % 2) ? m.sub(0, v) : v;
+    }
+    for (int s = 0; s < 3; ++s) p = ntt.square(move(p), len);
 
-    cout << fixed << setprecision(30);
-    cout << "q = exp(-2π√163) = " << q << "\n\n";
+    vector<u64> e4_cubed = ntt.multiply(ntt.square(e4, len), e4, len);
+    vector<u64> series = ntt.multiply(move(e4_cubed), ntt.inverse(p, len), len);
+    for (auto& x : series) x = m.from(x);
+    return series;
+}
 
-    // Start with floating evaluation
-    long double j_float = (1.0L / q) + 744.0L;
+// Primes of the product needed for c(n): c(n) < e^{4 pi sqrt(n)} < 2^{61 k}
+size_t primes_for(long long n) {
+    double bits = (n >= 1) ? 4.0 * M_PI * sqrt(double(n)) / log(2.0) : 10.0;
+    return size_t(bits / 61.0) + 1;
+}
 
-    long double qn = q;
-    for (int i = 0; i < terms && i < 5; ++i) {
-        j_float += C[i] * qn;
-        qn *= q;
+struct JStats {
+    size_t primes = 0;
+    double series_seconds = 0.0;
+    double crt_seconds = 0.0;
+};
+
+// c(-1), c(0), ..., c(N) as exact integers
+vector<mpz_class> j_coefficients(long long N, int threads, JStats* stats = nullptr) {
+    const size_t len = size_t(N) + 2;                 // series index m holds c(m - 1)
+    const size_t K = primes_for(N);
+    const vector<u64> primes = ntt_primes(K);
+    const vector<u64> sigma3 = sigma3_table(len);
+
+    // Residues mod prime i only for the indices that need it
+    vector<size_t> first(K);
+    for (size_t i = 0, m = 0; i < K; ++i) {
+        while (primes_for((long long)m - 1) <= i) ++m;
+        first[i] = m;
+    }
+    vector<vector<u64>> residues(K);
+    size_t transform_length = 1;
+    while (transform_length < 2 * len) transform_length *= 2;
+
+    auto start = chrono::steady_clock::now();
+    atomic<size_t> next_prime(0);
+    auto series_worker = [&] {
+        for (size_t i; (i = next_prime++) < K;) {
+            NttPrime ntt(primes[i], transform_length);
+            vector<u64> series = j_series_mod(ntt, sigma3, len);
+            residues[i].assign(series.begin() + first[i], series.end());
+        }
+    };
+    vector<thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(series_worker);
+    series_worker();
+    for (auto& th : pool) th.join();
+    auto mid = chrono::steady_clock::now();
+
+    // Garner: inverse[i][j] = p_j^{-1} mod p_i in Montgomery form of p_i,
+    // so mul(x, inverse[i][j]) = x p_j^{-1} for plain x
+    vector<Montgomery> mont;
+    for (u64 p : primes) mont.emplace_back(p);
+    vector<vector<u64>> inverse(K);
+    for (size_t i = 0; i < K; ++i)
+        for (size_t j = 0; j < i; ++j) {
+            u64 pj = mont[i].to(primes[j]);
+            inverse[i].push_back(mont[i].pow(pj, primes[i] - 2));
+        }
+
+    vector<mpz_class> c(len);
+    atomic<size_t> next_block(0);
+    const size_t block = 1024;
+    auto crt_worker = [&] {
+        vector<u64> digit(K);
+        for (size_t b; (b = next_block++) * block < len;)
+            for (size_t m = b * block; m < min(len, (b + 1) * block); ++m) {
+                size_t k = primes_for((long long)m - 1);
+                for (size_t i = 0; i < k; ++i) {
+                    const Montgomery& mi = mont[i];
+                    u64 x = residues[i][m - first[i]];
+                    for (size_t j = 0; j < i; ++j) {
+                        u64 v = digit[j] >= mi.p ? digit[j] - mi.p : digit[j];
+                        x = mi.mul(mi.sub(x, v), inverse[i][j]);
+                    }
+                    digit[i] = x;
+                }
+                mpz_class value = digit[k - 1];
+                for (size_t i = k - 1; i-- > 0;) {
+                    mpz_mul_ui(value.get_mpz_t(), value.get_mpz_t(), primes[i]);
+                    mpz_add_ui(value.get_mpz_t(), value.get_mpz_t(), digit[i]);
+                }
+                c[m] = move(value);
+            }
+    };
+    pool.clear();
+    for (int t = 1; t < threads; ++t) pool.emplace_back(crt_worker);
+    crt_worker();
+    for (auto& th : pool) th.join();
+
+    if (stats) {
+        stats->primes = K;
+        stats->series_seconds = chrono::duration<double>(mid - start).count();
+        stats->crt_seconds = chrono::duration<double>(chrono::steady_clock::now() - mid).count();
     }
+    return c;
+}
+
+// c(-1) .. c(N), kept and extended between calls
+const vector<mpz_class>& j_coefficient_prefix(long long N) {
+    static vector<mpz_class> c;
+    if (c.size() < size_t(N) + 2) c = j_coefficients(N, 1);
+    return c;
+}
 
+/*
+  Evaluation at arbitrary tau
+
+  j is invariant under SL2(Z), so tau is first moved into the
+  fundamental domain |Re tau| <= 1/2, |tau| >= 1, where
+  |q| <= e^{-pi sqrt(3)} < 0.0044. The series is then cut at the
+  first n with e^{4 pi sqrt(n)} |q|^{n+1} below 2^{-bits}, i.e.
+  relative to the leading 1/q, and summed by Horner's scheme in q.
+
+  GMP's mpf_class is used for the multiprecision arithmetic; pi
+  and exp are built here from its four operations and sqrt.
+*/
+struct complex_mpf {
+    mpf_class re, im;
+};
+
+complex_mpf operator+(const complex_mpf& a, const complex_mpf& b) {
+    return { a.re + b.re, a.im + b.im };
+}
+
+complex_mpf operator*(const complex_mpf& a, const complex_mpf& b) {
+    return { a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re };
+}
+
+// Default mpf precision for `digits` decimal digits plus guard bits;
+// every mpf_class created afterwards, in any thread, uses it
+unsigned long set_working_precision(int digits) {
+    unsigned long bits = (unsigned long)ceil(digits * log2(10.0)) + 96;
+    mpf_set_default_prec(bits);
+    return bits;
+}
+
+// 2^e
+mpf_class pow2(long e) {
+    mpf_class r = 1;
+    if (e >= 0) mpf_mul_2exp(r.get_mpf_t(), r.get_mpf_t(), e);
+    else mpf_div_2exp(r.get_mpf_t(), r.get_mpf_t(), -e);
+    return r;
+}
+
+// Gauss-Legendre: the correct digits double every iteration
+mpf_class mpf_pi(unsigned long bits) {
+    mpf_class a = 1, b = sqrt(mpf_class(0.5)), t = 0.25, p = 1;
+    for (unsigned long done = 1; done < 2 * bits; done *= 2) {
+        mpf_class next = (a + b) / 2;
+        b = sqrt(a * b);
+        t -= p * (a - next) * (a - next);
+        a = next;
+        p *= 2;
+    }
+    return (a + b) * (a + b) / (4 * t);
+}
+
+// e^z: Taylor series at z / 2^k, |z / 2^k| < 2^-8, then k squarings
+complex_mpf mpf_exp(const complex_mpf& z, unsigned long bits) {
+    double size = fabs(z.re.get_d()) + fabs(z.im.get_d());
+    long k = size > 0.0 ? max(0L, long(ceil(log2(size))) + 8) : 0;
+    complex_mpf w{ z.re * pow2(-k), z.im * pow2(-k) };
+
+    complex_mpf sum{ 1, 0 }, term{ 1, 0 };
+    const mpf_class eps = pow2(-long(bits) - 8);
+    for (int n = 1; abs(term.re) + abs(term.im) > eps; ++n) {
+        term = term * w;
+        term.re /= n;
+        term.im /= n;
+        sum = sum + term;
+    }
+    for (long i = 0; i < k; ++i) sum = sum * sum;
+    return sum;
+}
+
+struct JValue {
+    mpf_class x, y;                         // tau after reduction
+    long long terms;                        // c(0) .. c(terms - 1) used
+    complex_mpf j;
+};
+
+// Built once at a given precision, then shared read-only by threads
+struct JEvaluator {
+    unsigned long bits;                     // set first: fixes the mpf precision below
+    mpf_class two_pi;
+    vector<mpf_class> c;                    // c(n) at index n + 1
+
+    explicit JEvaluator(int digits)
+        : bits(set_working_precision(digits)), two_pi(2 * mpf_pi(bits)) {
+        const vector<mpz_class>& exact = j_coefficient_prefix(terms_for(0.866));
+        c.assign(exact.begin(), exact.begin() + terms_for(0.866) + 1);
+    }
+
+    // First n with e^{4 pi sqrt(n)} |q|^{n+1} < 2^{-bits} / e; past it
+    // the terms fall by at least e^{2 pi / sqrt(n) - 2 pi y} < 0.1
+    long long terms_for(double y) const {
+        const double target = -double(bits) * log(2.0) - 1.0;
+        long long n = 2;
+        while (4.0 * M_PI * sqrt(double(n)) - 2.0 * M_PI * y * (n + 1) > target) ++n;
+        return n;
+    }
+
+    // tau -> tau + m and tau -> -1/tau until |x| <= 1/2 and |tau| >= 1.
+    // Every inversion raises y, but a point on the unit circle can come
+    // out just inside it and flip back and forth under -1/tau, so the
+    // circle gets a rounding slack; any tau near the domain will do
+    void reduce(mpf_class& x, mpf_class& y) const {
+        const mpf_class circle = 1 - pow2(-long(bits) / 2);
+        while (true) {
+            x -= floor(x + 0.5);
+            mpf_class norm = x * x + y * y;
+            if (norm >= circle) return;
+            x = -x / norm;
+            y = y / norm;
+        }
+    }
+
+    JValue operator()(mpf_class x, mpf_class y) const {
+        reduce(x, y);
+        long long terms = min<long long>(terms_for(y.get_d()), c.size() - 1);
+        complex_mpf q = mpf_exp({ -two_pi * y, two_pi * x }, bits);
+
+        complex_mpf s{ c[terms], 0 };
+        for (long long n = terms - 2; n >= 0; --n) {
+            s = s * q;
+            s.re += c[n + 1];
+        }
+        mpf_class norm = q.re * q.re + q.im * q.im;
+        return { x, y, terms, s + complex_mpf{ q.re / norm, -q.im / norm } };
+    }
+};
+
+mpz_class compute_exact_core() {
+    mpz_class base("640320");
+    mpz_class cube = base * base * base;
+    return -cube;
+}
+
+void compute_j_invariant(int digits) {
+    cout << "\n[ Computing j((1 + i√163)/2) using Fourier expansion ]\n";
+
+    JEvaluator j_of(digits);
+    mpf_class sqrt163 = sqrt(mpf_class(163));
+    JValue v = j_of(mpf_class(0.5), sqrt163 / 2);
+
+    cout << defaultfloat << setprecision(digits);
+    cout << "Terms of the q-series: " << v.terms << "\n\n";
     cout << "Floating approximation:\n";
-    cout << "j(i√163) ≈ " << j_float << "\n\n";
+    cout << "j((1 + i√163)/2) ≈ " << v.j.re << " " << showpos << v.j.im << noshowpos << " i\n\n";
 
     // Exact algebraic integer core
     mpz_class exact_core = compute_exact_core();
-    mpz_class exact_value = exact_core + 744;
 
     cout << "Exact integer expression:\n";
-    cout << "j(i√163) = -640320^3 + 744\n";
-    cout << "            = " << exact_value << "\n\n";
+    cout << "j((1 + i√163)/2) = -640320^3\n";
+    cout << "                 = " << exact_core << "\n\n";
+
+    mpf_class difference = v.j.re - mpf_class(exact_core);
+    cout << setprecision(3) << "Difference (Floating - Exact) ≈ " << difference << "\n";
+
+    complex_mpf e = mpf_exp({ j_of.two_pi / 2 * sqrt163, 0 }, j_of.bits);
+    cout << setprecision(digits) << "\ne^{π√163} = " << e.re << "\n";
+    cout << setprecision(3) << "640320^3 + 744 - e^{π√163} ≈ "
+         << mpf_class(744 - exact_core) - e.re << "\n";
+}
+
+// j at one tau entered as decimal strings
+void evaluate_point() {
+    string x_text, y_text;
+    int digits;
+    cout << "\nEnter tau as Re Im (Im > 0, e.g. 0 1 or 0.5 0.8660254): ";
+    cin >> x_text >> y_text;
+    cout << "Digits: ";
+    cin >> digits;
+    if (!cin || digits < 1 || digits > 100000) {
+        cout << "Need 1 <= digits <= 100000.\n";
+        return;
+    }
+
+    JEvaluator j_of(digits);
+    mpf_class x, y;
+    if (x.set_str(x_text, 10) != 0 || y.set_str(y_text, 10) != 0 || y <= 0) {
+        cout << "Tau must be two decimal numbers with Im > 0.\n";
+        return;
+    }
+    JValue v = j_of(x, y);
+
+    cout << defaultfloat << setprecision(min(digits, 20));
+    cout << "Reduced tau = " << v.x << " + " << v.y << " i, " << v.terms << " terms\n";
+    cout << setprecision(digits) << "j(tau) = " << v.j.re << "\n"
+         << "         " << showpos << v.j.im << noshowpos << " i\n";
+}
 
-    mpz_class difference = exact_value - mpz_class(j_float);
-    cout << "Difference (Exact - Floating) ≈ " << difference << "\n";
+// Grid of tau for plotting: "x,y,re,im" lines, rows shared across threads
+void batch_grid() {
+    double x0, x1, y0, y1;
+    int nx, ny, digits, threads;
+    string path;
+    cout << "\nRe tau from, to, points: ";
+    cin >> x0 >> x1 >> nx;
+    cout << "Im tau from, to, points: ";
+    cin >> y0 >> y1 >> ny;
+    cout << "Digits: ";
+    cin >> digits;
+    cout << "Threads (0 = all cores): ";
+    cin >> threads;
+    cout << "CSV output file: ";
+    cin >> path;
+    if (!cin || nx < 1 || ny < 1 || !(y0 > 0.0) || !(y1 > 0.0) || digits < 1 || digits > 100000) {
+        cout << "Need at least one point per axis, Im tau > 0 and 1 <= digits <= 100000.\n";
+        return;
+    }
+    if (threads <= 0) threads = max(1u, thread::hardware_concurrency());
+
+    auto start = chrono::steady_clock::now();
+    JEvaluator j_of(digits);
+    vector<string> rows(ny);
+    atomic<int> next_row(0);
+    auto worker = [&] {
+        for (int r; (r = next_row++) < ny;) {
+            ostringstream line;
+            double y = (ny > 1) ? y0 + (y1 - y0) * r / (ny - 1) : y0;
+            for (int k = 0; k < nx; ++k) {
+                double x = (nx > 1) ? x0 + (x1 - x0) * k / (nx - 1) : x0;
+                JValue v = j_of(mpf_class(x), mpf_class(y));
+                line << setprecision(17) << x << "," << y << ","
+                     << setprecision(digits) << v.j.re << "," << v.j.im << "\n";
+            }
+            rows[r] = line.str();
+        }
+    };
+    vector<thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    ofstream out(path);
+    out << "x,y,re,im\n";
+    for (const auto& row : rows) out << row;
+    cout << (out ? "Wrote " : "Could not write ") << path << fixed << setprecision(2) << " ("
+         << 1LL * nx * ny << " points, " << threads << " thread(s), " << seconds << " s)\n";
+}
+
+// Table of c(n), n <= N, with checks for congruence and growth studies
+void coefficient_table() {
+    long long N;
+    int threads;
+    string path;
+    cout << "\nCompute c(n) for n <= N (N <= " << J_MAX_TERMS - 2 << "): ";
+    cin >> N;
+    cout << "Threads (0 = all cores): ";
+    cin >> threads;
+    cout << "Output file for \"n c(n)\" lines (or - for none): ";
+    cin >> path;
+    if (!cin || N < 1 || N > (long long)J_MAX_TERMS - 2) {
+        cout << "N must be between 1 and " << J_MAX_TERMS - 2 << ".\n";
+        return;
+    }
+    if (threads <= 0) threads = max(1u, thread::hardware_concurrency());
+
+    JStats stats;
+    vector<mpz_class> c = j_coefficients(N, threads, &stats);
+    auto at = [&](long long n) -> const mpz_class& { return c[n + 1]; };
+
+    cout << fixed << setprecision(2);
+    cout << "\n" << stats.primes << " primes, " << threads << " thread(s): "
+         << stats.series_seconds << " s series, " << stats.crt_seconds << " s CRT\n";
+
+    const char* known[] = { "1", "744", "196884", "21493760", "864299970",
+                            "20245856256", "333202640600" };
+    bool known_ok = true;
+    for (long long n = -1; n <= min(N, 5LL); ++n)
+        known_ok = known_ok && at(n) == mpz_class(known[n + 1]);
+    cout << "c(-1) .. c(" << min(N, 5LL) << ") against known values: "
+         << (known_ok ? "ok" : "MISMATCH") << "\n";
+
+    // c(n) ~ e^{4 pi sqrt(n)} / (sqrt(2) n^{3/4})
+    long exponent;
+    double mantissa = mpz_get_d_2exp(&exponent, at(N).get_mpz_t());
+    double log_c = log(mantissa) + exponent * log(2.0);
+    double log_main = 4.0 * M_PI * sqrt(double(N)) - 0.5 * log(2.0) - 0.75 * log(double(N));
+    cout << "c(" << N << ") has " << mpz_sizeinbase(at(N).get_mpz_t(), 10) << " digits\n";
+    cout << setprecision(10) << "c(N) sqrt(2) N^(3/4) / e^(4 pi sqrt(N)) = "
+         << exp(log_c - log_main) << "\n";
+
+    // Lehner: c(2m) = 0 mod 2^11, c(3m) mod 3^5, c(5m) mod 5^2, c(7m) mod 7, c(11m) mod 11
+    const int primes[] = { 2, 3, 5, 7, 11 };
+    const int powers[] = { 2048, 243, 25, 7, 11 };
+    for (int i = 0; i < 5; ++i) {
+        long long first_failure = 0;
+        for (long long n = primes[i]; n <= N && !first_failure; n += primes[i])
+            if (mpz_divisible_ui_p(at(n).get_mpz_t(), powers[i]) == 0) first_failure = n;
+        cout << "c(" << primes[i] << "m) = 0 mod " << powers[i] << ": "
+             << (first_failure ? "fails at n = " + to_string(first_failure) : string("holds")) << "\n";
+    }
+
+    if (path != "-") {
+        ofstream out(path);
+        for (long long n = -1; n <= N; ++n) out << n << " " << at(n) << "\n";
+        cout << (out ? "Wrote " : "Could not write ") << path << "\n";
+    }
 }
 
 int main() {
@@ -72,17 +658,30 @@ int main() {
     cout << "===============================================\n";
 
     while (true) {
-        int terms;
-        cout << "\nEnter number of Fourier terms (1–5 recommended): ";
-        cin >> terms;
+        int mode;
+        cout << "\n1) j((1 + i√163)/2) against -640320^3   2) j(tau) at a point\n"
+             << "3) Batch grid of tau to CSV              4) Coefficient table c(n)\n> ";
+        cin >> mode;
+        if (!cin) break;
 
-        compute_j_invariant(terms);
+        if (mode == 2) {
+            evaluate_point();
+        } else if (mode == 3) {
+            batch_grid();
+        } else if (mode == 4) {
+            coefficient_table();
+        } else {
+            int digits;
+            cout << "\nEnter number of digits (e.g. 50): ";
+            cin >> digits;
+            if (cin && digits >= 1 && digits <= 100000) compute_j_invariant(digits);
+        }
 
         char choice;
         cout << "\nCompute again? (y/n): ";
         cin >> choice;
 
-        if (choice != 'y' && choice != 'Y') {
+        if (!cin || (choice != 'y' && choice != 'Y')) {
             cout << "\nProgram terminated. Stay legendary.\n";
             break;
         }
@@ -1,133 +1,1289 @@
 #include <iostream>
+#include <cassert>
 #include <cmath>
 #include <limits>
 #include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <utility>
+#include <numeric>
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <gmpxx.h>
 
 using namespace std;
 
 /*
  ============================================================
   Birch–Swinnerton-Dyer Regulator Explorer
-  Elliptic Curve: y^2 = x^3 + 7823
+  Elliptic Curve: y^2 = x^3 + 7823 (any y^2 = x^3 + Ax + B at runtime)
   Author: Research-Grade Numerical Prototype
  ============================================================
+
+  Points are kept in Jacobian coordinates over Z, so every
+  multiple of P is exact and no field inversion is needed.
 */
 
-static const long double A = 0.0L;
-static const long double B = 7823.0L;
+/* ---------------- Elliptic Curve ---------------- */
+
+// y^2 = x^3 + A x + B over Z
+struct Curve {
+    mpz_class A;
+    mpz_class B;
+};
+
+static const Curve DEFAULT_CURVE = {0, 7823};
+
+string curveName(const Curve& E) {
+    string s = "y^2 = x^3";
+    if (E.A != 0) s += (E.A < 0 ? " - " : " + ") + mpz_class(abs(E.A)).get_str() + "x";
+    if (E.B != 0) s += (E.B < 0 ? " - " : " + ") + mpz_class(abs(E.B)).get_str();
+    return s;
+}
 
 /* ---------------- Elliptic Curve Point ---------------- */
 
+// Jacobian coordinates: x = X / Z^2, y = Y / Z^3, Z = 0 is the point at infinity
 struct ECPoint {
-    long double x;
-    long double y;
-    bool infinity;
+    mpz_class X;
+    mpz_class Y;
+    mpz_class Z;
+
+    ECPoint() : X(1), Y(1), Z(0) {}
+    ECPoint(const mpz_class& _X, const mpz_class& _Y, const mpz_class& _Z)
+        : X(_X), Y(_Y), Z(_Z) {}
+
+    bool infinity() const { return Z == 0; }
+
+    mpq_class x() const {
+        mpq_class r(X, Z * Z);
+        r.canonicalize();
+        return r;
+    }
 
-    ECPoint() : x(0), y(0), infinity(true) {}
-    ECPoint(long double _x, long double _y) : x(_x), y(_y), infinity(false) {}
+    mpq_class y() const {
+        mpq_class r(Y, Z * Z * Z);
+        r.canonicalize();
+        return r;
+    }
 };
 
 /* ---------------- Utility ---------------- */
 
+// log|n| for arbitrarily large n (n != 0)
+long double logAbs(const mpz_class& n) {
+    long e;
+    double m = mpz_get_d_2exp(&e, n.get_mpz_t());
+    return logl(fabsl((long double)m)) + e * logl(2.0L);
+}
+
+bool onCurve(const Curve& E, const mpq_class& x, const mpq_class& y) {
+    return y * y == x * x * x + E.A * x + E.B;
+}
+
+/*
+ Jacobian representative of an affine rational point. On an integral
+ Weierstrass model x = a/d^2 and y = b/d^3, so Z = d gives integral X, Y.
+*/
+bool fromAffine(const mpq_class& x, const mpq_class& y, ECPoint& P) {
+    mpz_class d;
+    mpz_sqrt(d.get_mpz_t(), x.get_den_mpz_t());
+    if (d * d != x.get_den() || d * d * d != y.get_den())
+        return false;
+
+    P = ECPoint(x.get_num(), y.get_num(), d);
+    return true;
+}
+
+// Smallest integral representative (lambda^2 X, lambda^3 Y, lambda Z) of P
+ECPoint canonical(const ECPoint& P) {
+    if (P.infinity()) return ECPoint();
+
+    mpq_class x = P.x(), y = P.y();
+    ECPoint R;
+    fromAffine(x, y, R);
+    return R;
+}
+
 long double naiveHeight(const ECPoint& P) {
-    if (P.infinity) return 0.0L;
-    return logl(max(1.0L, fabsl(P.x)));
+    if (P.infinity()) return 0.0L;
+    mpq_class x = P.x();
+    mpz_class num = abs(x.get_num());
+    const mpz_class& den = x.get_den();
+    return logAbs(num > den ? num : den);
 }
 
 /* ---------------- Elliptic Curve Arithmetic ---------------- */
 
-ECPoint add(const ECPoint& P, const ECPoint& Q) {
-    if (P.infinity) return Q;
-    if (Q.infinity) return P;
+ECPoint negatePoint(const ECPoint& P) {
+    return ECPoint(P.X, -P.Y, P.Z);
+}
+
+// dbl-2007-bl with general a
+ECPoint doublePoint(const Curve& E, const ECPoint& P) {
+    if (P.infinity() || P.Y == 0) return ECPoint();
 
-    if (fabsl(P.x - Q.x) < 1e-18L && fabsl(P.y + Q.y) < 1e-18L)
-        return ECPoint(); // Point at infinity
+    mpz_class XX = P.X * P.X;
+    mpz_class YY = P.Y * P.Y;
+    mpz_class S = 4 * P.X * YY;
+    mpz_class M = 3 * XX;
+    if (E.A != 0) {
+        mpz_class ZZ = P.Z * P.Z;
+        M += E.A * ZZ * ZZ;
+    }
 
-    long double lambda;
+    mpz_class X3 = M * M - 2 * S;
+    mpz_class Y3 = M * (S - X3) - 8 * YY * YY;
+    mpz_class Z3 = 2 * P.Y * P.Z;
+    return ECPoint(X3, Y3, Z3);
+}
 
-    if (fabsl(P.x - Q.x) < 1e-18L) {
-        // Point doubling
-        lambda = (3 * P.x * P.x + A) / (2 * P.y);
-    } else {
-        // Point addition
-        lambda = (Q.y - P.y) / (Q.x - P.x);
+ECPoint add(const Curve& E, const ECPoint& P, const ECPoint& Q) {
+    if (P.infinity()) return Q;
+    if (Q.infinity()) return P;
+
+    mpz_class Z1Z1 = P.Z * P.Z;
+    mpz_class Z2Z2 = Q.Z * Q.Z;
+    mpz_class U1 = P.X * Z2Z2;
+    mpz_class U2 = Q.X * Z1Z1;
+    mpz_class S1 = P.Y * Q.Z * Z2Z2;
+    mpz_class S2 = Q.Y * P.Z * Z1Z1;
+
+    mpz_class H = U2 - U1;
+    mpz_class r = S2 - S1;
+
+    if (H == 0) {
+        if (r == 0) return doublePoint(E, P);
+        return ECPoint(); // P = -Q
     }
 
-    long double xr = lambda * lambda - P.x - Q.x;
-    long double yr = lambda * (P.x - xr) - P.y;
+    mpz_class HH = H * H;
+    mpz_class HHH = H * HH;
+    mpz_class V = U1 * HH;
 
-    return ECPoint(xr, yr);
+    mpz_class X3 = r * r - HHH - 2 * V;
+    mpz_class Y3 = r * (V - X3) - S1 * HHH;
+    mpz_class Z3 = P.Z * Q.Z * H;
+    return ECPoint(X3, Y3, Z3);
 }
 
-ECPoint multiply(ECPoint P, int k) {
-    ECPoint result;
+/*
+ Width-w non-adjacent form of k: odd digits |d| < 2^(w-1), and any
+ w consecutive digits hold at most one nonzero. Least significant first.
+*/
+vector<int> wNAF(mpz_class k, int w) {
+    vector<int> digits;
+    const long window = 1L << w;
+
     while (k > 0) {
-        if (k & 1) result = add(result, P);
-        P = add(P, P);
+        int d = 0;
+        if (mpz_odd_p(k.get_mpz_t())) {
+            d = (int)mpz_fdiv_ui(k.get_mpz_t(), window);
+            if (d >= window / 2) d -= (int)window;
+            k -= d;
+        }
+        digits.push_back(d);
         k >>= 1;
     }
-    return result;
+    return digits;
+}
+
+/*
+ kP by left-to-right wNAF: one doubling per bit plus roughly one
+ addition per w + 1 bits, from a table of odd multiples P, 3P, ...
+*/
+ECPoint multiply(const Curve& E, const ECPoint& P, const mpz_class& k) {
+    if (k == 0 || P.infinity()) return ECPoint();
+    if (k < 0) return multiply(E, negatePoint(P), -k);
+
+    size_t bits = mpz_sizeinbase(k.get_mpz_t(), 2);
+    int w = bits > 120 ? 5 : (bits > 24 ? 4 : 2);
+
+    vector<ECPoint> odd(1 << (w - 2));
+    odd[0] = P;
+    ECPoint twoP = doublePoint(E, P);
+    for (size_t i = 1; i < odd.size(); ++i)
+        odd[i] = add(E, odd[i - 1], twoP);
+
+    vector<int> digits = wNAF(k, w);
+    ECPoint result;
+    for (size_t i = digits.size(); i-- > 0;) {
+        result = doublePoint(E, result);
+        int d = digits[i];
+        if (d > 0) result = add(E, result, odd[d / 2]);
+        else if (d < 0) result = add(E, result, negatePoint(odd[-d / 2]));
+    }
+    return canonical(result);
+}
+
+/* ---------------- Multiprecision Helpers ---------------- */
+
+mpf_class mpfEpsilon(mp_bitcnt_t prec) {
+    mpf_class eps(1, prec);
+    mpf_div_2exp(eps.get_mpf_t(), eps.get_mpf_t(), prec);
+    return eps;
+}
+
+// 2 atanh(s) = log((1 + s) / (1 - s)), for |s| <= 1/3
+mpf_class twiceAtanh(const mpf_class& s, mp_bitcnt_t prec) {
+    mpf_class sum(s, prec), power(s, prec), s2(s * s, prec), eps = mpfEpsilon(prec);
+    for (unsigned long k = 3; abs(power) > eps; k += 2) {
+        power *= s2;
+        sum += power / k;
+    }
+    return mpf_class(2 * sum, prec);
+}
+
+// Natural logarithm of x > 0: x = y 2^e with y in [1/2, 1)
+mpf_class mpfLog(const mpf_class& x, mp_bitcnt_t prec) {
+    long e;
+    mpf_get_d_2exp(&e, x.get_mpf_t());
+
+    mpf_class y(x, prec);
+    if (e >= 0) mpf_div_2exp(y.get_mpf_t(), y.get_mpf_t(), e);
+    else        mpf_mul_2exp(y.get_mpf_t(), y.get_mpf_t(), -e);
+
+    mpf_class third(1, prec);
+    third /= 3;
+    mpf_class ln2 = twiceAtanh(third, prec);
+    mpf_class logy = twiceAtanh(mpf_class((y - 1) / (y + 1), prec), prec);
+    return mpf_class(logy + ln2 * e, prec);
+}
+
+mpf_class mpfLog(const mpz_class& n, mp_bitcnt_t prec) {
+    return mpfLog(mpf_class(abs(n), prec), prec);
+}
+
+/* ---------------- Integer Factorization ---------------- */
+
+// Pollard–Brent rho; n odd composite
+mpz_class pollardBrent(const mpz_class& n) {
+    for (unsigned long c = 1;; ++c) {
+        mpz_class y = 2, x, ys, q = 1, g = 1;
+        const unsigned long m = 128;
+        unsigned long r = 1;
+
+        auto f = [&](const mpz_class& v) {
+            mpz_class w = v * v + c;
+            mpz_mod(w.get_mpz_t(), w.get_mpz_t(), n.get_mpz_t());
+            return w;
+        };
+
+        do {
+            x = y;
+            for (unsigned long i = 0; i < r; ++i) y = f(y);
+            for (unsigned long k = 0; k < r && g == 1; k += m) {
+                ys = y;
+                for (unsigned long i = 0; i < min(m, r - k); ++i) {
+                    y = f(y);
+                    q = q * abs(x - y) % n;
+                }
+                g = gcd(q, n);
+            }
+            r *= 2;
+        } while (g == 1);
+
+        if (g == n) {
+            do {
+                ys = f(ys);
+                g = gcd(abs(x - ys), n);
+            } while (g == 1);
+        }
+        if (g != n) return g;
+    }
+}
+
+void factorInto(mpz_class n, vector<mpz_class>& primes) {
+    n = abs(n);
+    for (unsigned long p = 2; p < 10000 && n > 1; ++p) {
+        if (mpz_divisible_ui_p(n.get_mpz_t(), p)) {
+            primes.push_back(p);
+            while (mpz_divisible_ui_p(n.get_mpz_t(), p)) n /= p;
+        }
+    }
+    if (n == 1) return;
+    if (mpz_probab_prime_p(n.get_mpz_t(), 30)) {
+        primes.push_back(n);
+        return;
+    }
+    mpz_class d = pollardBrent(n);
+    factorInto(d, primes);
+    factorInto(n / d, primes);
+}
+
+// Distinct prime factors, ascending
+vector<mpz_class> primeFactors(const mpz_class& n) {
+    vector<mpz_class> primes;
+    factorInto(n, primes);
+    sort(primes.begin(), primes.end());
+    primes.erase(unique(primes.begin(), primes.end()), primes.end());
+    return primes;
+}
+
+unsigned long valuation(mpz_class n, const mpz_class& p) {
+    if (n == 0) return numeric_limits<unsigned long>::max();
+    return mpz_remove(n.get_mpz_t(), n.get_mpz_t(), p.get_mpz_t());
+}
+
+/* ---------------- Canonical Height via Local Heights ---------------- */
+
+/*
+ Silverman, "Computing heights on elliptic curves" (Math. Comp. 1988):
+
+   h^(P) = lambda_inf(P) + sum_p lambda_p(P)
+
+ with the discriminant-free normalisation of each local height (the
+ (1/12) log|Delta|_v terms cancel by the product formula). The result is
+ reported in the BSD normalisation h^ ~ h(x), twice Silverman's.
+
+ At a prime where P reduces to a nonsingular point, lambda_p is
+ (1/2) max(0, -v_p(x)) log p; summed over p this is log d for
+ x = a/d^2. Only primes dividing gcd(2y, 3x^2 + A, Delta) can see a
+ singular reduction, so it is that divisor of Delta which is factored.
+*/
+
+struct HeightReport {
+    mpf_class archimedean;
+    mpf_class nonArchimedean;
+    mpf_class height;
+    mpf_class errorBound;   // |computed - true| <= errorBound
+    vector<string> notes;
+
+    explicit HeightReport(mp_bitcnt_t prec)
+        : archimedean(0, prec), nonArchimedean(0, prec), height(0, prec), errorBound(0, prec) {}
+};
+
+// Affine coordinates as x = a/d^2, y = b/d^3 on y^2 = x^3 + Ax + B
+struct IntegralCoordinates {
+    mpz_class a, b, d;
+};
+
+IntegralCoordinates integralCoordinates(const ECPoint& P) {
+    ECPoint Q = canonical(P);
+    return {Q.X, Q.Y, Q.Z};
+}
+
+mpz_class discriminant(const Curve& E) {
+    return -16 * (4 * E.A * E.A * E.A + 27 * E.B * E.B);
+}
+
+// Real roots of x^3 + Ax + B in increasing order (one or three), by
+// bisection on the intervals where the cubic is monotone: left of the
+// local maximum at -sqrt(-A/3), between the extrema, right of the minimum
+vector<long double> realRoots(const Curve& E) {
+    long double a4 = E.A.get_d(), a6 = E.B.get_d();
+    auto cubic = [&](long double x) { return x * x * x + a4 * x + a6; };
+    auto bisect = [&](long double lo, long double hi) {
+        bool rising = cubic(lo) < cubic(hi);
+        for (int it = 0; it < 200; ++it) {
+            long double mid = (lo + hi) / 2;
+            ((cubic(mid) < 0) == rising ? lo : hi) = mid;
+        }
+        return lo;
+    };
+
+    long double s = a4 < 0 ? sqrtl(-a4 / 3) : 0.0L;
+    bool left = cubic(-s) >= 0, right = cubic(s) <= 0;
+    if (a4 >= 0) right = !left;
+
+    vector<long double> roots;
+    if (left) {
+        long double step = 1;
+        while (cubic(-s - step) >= 0) step *= 2;
+        roots.push_back(bisect(-s - step, -s));
+    }
+    if (left && right && a4 < 0) roots.push_back(bisect(-s, s));
+    if (right) {
+        long double step = 1;
+        while (cubic(s + step) <= 0) step *= 2;
+        roots.push_back(bisect(s, s + step));
+    }
+    return roots;
+}
+
+// Every real point has x >= the smallest root (rounded down by bisection)
+long double smallestRealRoot(const Curve& E) {
+    return realRoots(E).front();
+}
+
+/*
+ Tate's series on the model shifted by x = x' + r, with r chosen so that
+ every real point has x' >= 1; then z never vanishes on E(R) and
+
+   lambda_inf = (1/2) log|x'| + (1/8) sum_n 4^-n log|z(2^n P)|,
+
+ where t = 1/x', t(2Q) = w(t)/z(t). Each term gains two bits, so the
+ cost is linear in the requested precision.
+
+ The truncated tail is at most (4/3) weight * sup|log|z||, with the sup
+ taken over the t of real points: |z| is bounded above termwise over
+ [0, 1/x'_min] and below by sampling those t with a Lipschitz margin. If no positive lower bound is found
+ the error bound is reported as infinite.
+*/
+mpf_class archimedeanHeight(const Curve& E, const IntegralCoordinates& c, mp_bitcnt_t prec,
+                            mpf_class& errorBound) {
+    long double root = smallestRealRoot(E);
+    mpz_class r(static_cast<double>(floorl(root)) - 2.0);
+
+    // Coefficients of the shifted model y^2 = x'^3 + a2 x'^2 + a4' x' + a6'
+    mpz_class a2 = 3 * r;
+    mpz_class a4s = 3 * r * r + E.A;
+    mpz_class a6s = r * r * r + E.A * r + E.B;
+    mpf_class b2(4 * a2, prec), b4(2 * a4s, prec), b6(4 * a6s, prec);
+    mpf_class b8(4 * a2 * a6s - a4s * a4s, prec);
+
+    mpf_class x(mpq_class(c.a - r * c.d * c.d, c.d * c.d), prec);
+    mpf_class t(1 / x, prec);
+    assert(x >= 1);                           // Tate's series needs x' >= 1 on E(R)
+    mpf_class sum(mpfLog(x, prec) / 2, prec);
+
+    mpf_class weight(1, prec), eps = mpfEpsilon(prec);
+    weight /= 8;
+    for (int n = 0; weight > eps; ++n) {
+        mpf_class t2(t * t, prec);
+        mpf_class w(4 * t + b2 * t2 + 2 * b4 * t2 * t + b6 * t2 * t2, prec);
+        mpf_class z(1 - b4 * t2 - 2 * b6 * t2 * t - b8 * t2 * t2, prec);
+        sum += weight * mpfLog(mpf_class(abs(z), prec), prec);
+        t = w / z;
+        weight /= 4;
+    }
+
+    // Bounds for |z(t)| over the t of real points only: x' >= e3 - r and,
+    // with three real roots e1 < e2 < e3, also e1 - r <= x' <= e2 - r.
+    // In the gap between e2 and e3 there is no real point and z can vanish
+    vector<long double> roots = realRoots(E);
+    const long double rd = r.get_d();
+    vector<pair<long double, long double>> ranges = {{0.0L, 1.0L / (roots.back() - rd)}};
+    if (roots.size() == 3) ranges.push_back({1.0L / (roots[1] - rd), 1.0L / (roots[0] - rd)});
+
+    long double T = 1.0L / (root - rd);
+    long double B4 = b4.get_d(), B6 = b6.get_d(), B8 = b8.get_d();
+    long double zMax = 1 + fabsl(B4) * T * T + 2 * fabsl(B6) * T * T * T + fabsl(B8) * T * T * T * T;
+    long double slope = 2 * fabsl(B4) * T + 6 * fabsl(B6) * T * T + 4 * fabsl(B8) * T * T * T;
+    long double zMin = 0.0L;
+    for (int K = 1 << 12; K <= (1 << 20) && zMin <= 0; K <<= 2) {
+        zMin = numeric_limits<long double>::infinity();
+        for (const auto& range : ranges) {
+            long double width = range.second - range.first;
+            long double lowest = numeric_limits<long double>::infinity();
+            for (int k = 0; k <= K; ++k) {
+                long double s = range.first + width * k / K, s2 = s * s;
+                lowest = min(lowest, fabsl(1 - B4 * s2 - 2 * B6 * s2 * s - B8 * s2 * s2));
+            }
+            zMin = min(zMin, lowest * (1 - 1e-12L) - slope * width / (2 * K));
+        }
+    }
+
+    if (zMin <= 0) {
+        errorBound = mpf_class(numeric_limits<double>::max(), prec);
+    } else {
+        double L = static_cast<double>(max(fabsl(logl(zMin)), fabsl(logl(zMax))));
+        mpf_class rounding(mpfEpsilon(prec) * (abs(sum) + L) * 4 * prec, prec);
+        errorBound = mpf_class(weight * 4 / 3 * L, prec) + rounding;
+    }
+    return sum;
+}
+
+/*
+ Silverman's correction at a prime p where P reduces to a singular point,
+ for a model minimal at p. Returns false if minimality is not certain.
+*/
+bool singularLocalHeight(const Curve& E, const IntegralCoordinates& c, const mpz_class& p,
+                         mp_bitcnt_t prec, mpf_class& lambda) {
+    mpz_class c4 = -48 * E.A, c6 = -864 * E.B;
+    unsigned long vc4 = valuation(c4, p), vc6 = valuation(c6, p);
+    unsigned long N = valuation(discriminant(E), p);
+
+    if (vc4 >= 4 && vc6 >= 6 && N >= 12)
+        return false; // possibly non-minimal at p
+
+    // psi_2 = 2y, psi_3 = 3x^4 + 6Ax^2 + 12Bx - A^2, cleared of d
+    mpz_class d2 = c.d * c.d, d4 = d2 * d2;
+    unsigned long v2 = valuation(2 * c.b, p);
+    unsigned long v3 = valuation(3 * c.a * c.a * c.a * c.a + 6 * E.A * c.a * c.a * d4
+                                 + 12 * E.B * c.a * d4 * d2 - E.A * E.A * d4 * d4, p);
+
+    mpf_class logp = mpfLog(p, prec);
+    if (vc4 == 0) {
+        // multiplicative reduction
+        mpf_class M(min(static_cast<double>(v2), N / 2.0), prec);
+        lambda = -M * (N - M) / (2 * N) * logp;
+    } else if (v3 >= 3 * v2) {
+        lambda = -mpf_class(v2, prec) / 3 * logp;
+    } else {
+        lambda = -mpf_class(v3, prec) / 8 * logp;
+    }
+    return true;
+}
+
+// gcd(2y, 3x^2 + A, Delta) in integral coordinates; 1 iff P is in E_0 everywhere
+mpz_class singularSupport(const Curve& E, const IntegralCoordinates& c) {
+    mpz_class d4 = c.d * c.d * c.d * c.d;
+    return gcd(gcd(2 * c.b, 3 * c.a * c.a + E.A * d4), discriminant(E));
+}
+
+HeightReport canonicalHeight(const Curve& E, const ECPoint& P, mp_bitcnt_t prec = 160) {
+    HeightReport rep(prec);
+    if (P.infinity()) return rep;
+
+    IntegralCoordinates c = integralCoordinates(P);
+    mpz_class support = singularSupport(E, c);
+    mpz_class m = 1;
+
+    bool minimal = true;
+    vector<pair<mpz_class, mpf_class>> corrections;
+    for (const mpz_class& p : primeFactors(support)) {
+        mpf_class lambda(0, prec);
+        if (!singularLocalHeight(E, c, p, prec, lambda)) { minimal = false; break; }
+        corrections.emplace_back(p, lambda);
+    }
+
+    if (!minimal) {
+        /*
+         Model possibly non-minimal at a singular prime: use
+         h^(P) = h^(mP) / m^2 with mP nonsingular at every prime, where
+         the local heights need no correction on any integral model.
+        */
+        ECPoint Q = P;
+        for (m = 2; m <= 720; ++m) {
+            Q = add(E, Q, P);
+            if (Q.infinity()) return rep; // torsion
+            c = integralCoordinates(Q);
+            if (singularSupport(E, c) == 1) break;
+        }
+        corrections.clear();
+        rep.notes.push_back("non-minimal model: used " + m.get_str() + "P, which has nonsingular reduction");
+    }
+
+    mpf_class scale(m * m, prec);
+    mpf_class archError(0, prec);
+    rep.archimedean = archimedeanHeight(E, c, prec, archError) / scale;
+    rep.nonArchimedean = (c.d == 1 ? mpf_class(0, prec) : mpfLog(c.d, prec)) / scale;
+    for (const auto& [p, lambda] : corrections) {
+        rep.nonArchimedean += lambda;
+        rep.notes.push_back("singular reduction at p = " + p.get_str());
+    }
+
+    // Logarithms are good to a few ulps; the tail bound dominates
+    mpf_class logError(mpfEpsilon(prec) * 16 * (abs(rep.nonArchimedean) + 1), prec);
+    rep.errorBound = 2 * (archError / scale + logError);
+
+    // BSD normalisation: twice Silverman's local-height sum
+    rep.archimedean *= 2;
+    rep.nonArchimedean *= 2;
+    rep.height = rep.archimedean + rep.nonArchimedean;
+    return rep;
+}
+
+/* ---------------- Néron–Tate Pairing and Regulator ---------------- */
+
+/*
+ <P, Q> = (h^(P + Q) - h^(P) - h^(Q)) / 2 for every pair, and
+ R = det(<P_i, P_j>). The r(r+1)/2 sums are formed inversion-free in
+ Jacobian coordinates; their heights dominate the cost and are handed
+ out to threads one at a time.
+
+ The determinant bound follows from multilinearity in the columns:
+ det(M + E) - det(M) = sum_k det(C_k), where C_k takes columns < k from
+ M + E, column k from E and the rest from M, so Hadamard's inequality
+ gives |sum| <= sum_k |E_k| prod_{j<k} (|M_j| + |E_j|) prod_{j>k} |M_j|.
+*/
+
+struct RegulatorReport {
+    vector<vector<mpf_class>> pairing;
+    mpf_class regulator;
+    mpf_class errorBound;
+    double seconds = 0.0;
+};
+
+mpf_class determinant(vector<vector<mpf_class>> M, mp_bitcnt_t prec) {
+    const size_t r = M.size();
+    mpf_class det(1, prec);
+
+    for (size_t k = 0; k < r; ++k) {
+        size_t pivot = k;
+        for (size_t i = k + 1; i < r; ++i)
+            if (abs(M[i][k]) > abs(M[pivot][k])) pivot = i;
+        if (M[pivot][k] == 0) return mpf_class(0, prec);
+        if (pivot != k) {
+            swap(M[pivot], M[k]);
+            det = -det;
+        }
+        det *= M[k][k];
+        for (size_t i = k + 1; i < r; ++i) {
+            mpf_class f(M[i][k] / M[k][k], prec);
+            for (size_t j = k; j < r; ++j) M[i][j] -= f * M[k][j];
+        }
+    }
+    return det;
 }
 
-/* ---------------- Canonical Height Approximation ---------------- */
+RegulatorReport computeRegulator(const Curve& E, const vector<ECPoint>& points,
+                                 unsigned numThreads, mp_bitcnt_t prec = 160) {
+    auto t0 = chrono::steady_clock::now();
+    const size_t r = points.size();
 
-long double canonicalHeight(ECPoint P, int iterations = 15) {
-    long double height = 0.0L;
-    ECPoint Q = P;
+    vector<pair<size_t, size_t>> jobs;
+    for (size_t i = 0; i < r; ++i)
+        for (size_t j = i; j < r; ++j) jobs.emplace_back(i, j);
 
-    for (int n = 1; n <= iterations; ++n) {
-        Q = add(Q, Q); // 2^n P
-        long double h = naiveHeight(Q);
-        long double scaled = h / powl(4.0L, n);
-        height = scaled;
+    vector<HeightReport> heights(jobs.size(), HeightReport(prec));
+    atomic<size_t> nextJob(0);
+
+    auto worker = [&]() {
+        for (size_t k; (k = nextJob++) < jobs.size();) {
+            auto [i, j] = jobs[k];
+            ECPoint S = (i == j) ? points[i] : canonical(add(E, points[i], points[j]));
+            heights[k] = canonicalHeight(E, S, prec);
+        }
+    };
+
+    vector<thread> threads;
+    for (unsigned t = 1; t < numThreads; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& th : threads) th.join();
+
+    vector<vector<const HeightReport*>> h(r, vector<const HeightReport*>(r));
+    for (size_t k = 0; k < jobs.size(); ++k) {
+        h[jobs[k].first][jobs[k].second] = &heights[k];
+        h[jobs[k].second][jobs[k].first] = &heights[k];
+    }
+
+    RegulatorReport rep;
+    rep.pairing.assign(r, vector<mpf_class>(r, mpf_class(0, prec)));
+    vector<vector<mpf_class>> err(r, vector<mpf_class>(r, mpf_class(0, prec)));
+    for (size_t i = 0; i < r; ++i)
+        for (size_t j = 0; j < r; ++j) {
+            if (i == j) {
+                rep.pairing[i][i] = h[i][i]->height;
+                err[i][i] = h[i][i]->errorBound;
+            } else {
+                rep.pairing[i][j] = (h[i][j]->height - h[i][i]->height - h[j][j]->height) / 2;
+                err[i][j] = (h[i][j]->errorBound + h[i][i]->errorBound + h[j][j]->errorBound) / 2;
+            }
+        }
+
+    rep.regulator = mpf_class(determinant(rep.pairing, prec), prec);
+
+    // Column norms of M and E for the Hadamard telescoping bound
+    vector<mpf_class> mNorm(r, mpf_class(0, prec)), eNorm(r, mpf_class(0, prec));
+    for (size_t j = 0; j < r; ++j) {
+        for (size_t i = 0; i < r; ++i) {
+            mNorm[j] += rep.pairing[i][j] * rep.pairing[i][j];
+            eNorm[j] += err[i][j] * err[i][j];
+        }
+        mpf_sqrt(mNorm[j].get_mpf_t(), mNorm[j].get_mpf_t());
+        mpf_sqrt(eNorm[j].get_mpf_t(), eNorm[j].get_mpf_t());
     }
 
-    return height;
+    rep.errorBound = mpf_class(0, prec);
+    mpf_class hadamard(1, prec);
+    for (size_t k = 0; k < r; ++k) {
+        mpf_class term(eNorm[k], prec);
+        for (size_t j = 0; j < r; ++j) {
+            if (j < k) term *= mNorm[j] + eNorm[j];
+            else if (j > k) term *= mNorm[j];
+        }
+        rep.errorBound += term;
+        hadamard *= mNorm[k] + eNorm[k];
+    }
+    // Rounding in the elimination itself, far below the input errors at this precision
+    rep.errorBound += mpfEpsilon(prec) * hadamard * (r * r * r + 1);
+
+    rep.seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    return rep;
+}
+
+/* ---------------- Rational Point Search ---------------- */
+
+/*
+ Points with x = a/d^2, gcd(a, d) = 1 and naive height max(|a|, d^2) <= H
+ are exactly the solutions of b^2 = a^3 + A a d^4 + B d^6. For each d the
+ a-range is cut into blocks; each block is sieved 64 candidates per word
+ by AND-ing quadratic-residue patterns modulo small prime powers, and
+ only survivors get the exact 128-bit square test.
+*/
+
+static const int SIEVE_MODULI[] = {64, 27, 25, 49, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61};
+static const size_t SIEVE_COUNT = sizeof(SIEVE_MODULI) / sizeof(SIEVE_MODULI[0]);
+
+struct FoundPoint {
+    long long a;
+    long long d;
+    __int128 b;   // y = b / d^3, b >= 0
+};
+
+struct SearchTask {
+    long long d;
+    long long aBegin;
+    long long aEnd;   // inclusive
+};
+
+/*
+ Per-thread deques: owners pop from the back, idle threads steal from the
+ front of a victim, so uneven blocks (small d sieve faster) balance out.
+*/
+class WorkStealingQueues {
+public:
+    explicit WorkStealingQueues(size_t workers) : queues(workers) {}
+
+    void push(size_t worker, const SearchTask& task) {
+        queues[worker].tasks.push_back(task);
+    }
+
+    bool next(size_t worker, SearchTask& task) {
+        {
+            Queue& own = queues[worker];
+            lock_guard<mutex> lock(own.m);
+            if (!own.tasks.empty()) {
+                task = own.tasks.back();
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t k = 1; k < queues.size(); ++k) {
+            Queue& victim = queues[(worker + k) % queues.size()];
+            lock_guard<mutex> lock(victim.m);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    struct Queue {
+        mutex m;
+        deque<SearchTask> tasks;
+    };
+    vector<Queue> queues;
+};
+
+// Quadratic-residue patterns for one d: word[r] has bit j set iff a = r + j (mod m) may work
+struct ResiduePatterns {
+    vector<uint64_t> words[SIEVE_COUNT];
+
+    void build(long long d, const vector<vector<char>>& isSquare, long long A64, long long B64) {
+        for (size_t s = 0; s < SIEVE_COUNT; ++s) {
+            const long long m = SIEVE_MODULI[s];
+            long long dm = d % m;
+            long long d2 = dm * dm % m, d4 = d2 * d2 % m, d6 = d4 * d2 % m;
+            long long ad4 = ((A64 % m + m) % m) * d4 % m;
+            long long bd6 = ((B64 % m + m) % m) * d6 % m;
+
+            vector<char> ok(m);
+            for (long long r = 0; r < m; ++r)
+                ok[r] = isSquare[s][(r * r % m * r + ad4 * r + bd6) % m];
+
+            words[s].assign(m, 0);
+            for (long long r = 0; r < m; ++r)
+                for (int j = 0; j < 64; ++j)
+                    if (ok[(r + j) % m]) words[s][r] |= uint64_t(1) << j;
+        }
+    }
+};
+
+bool exactSquare(__int128 v, __int128& root) {
+    if (v < 0) return false;
+    __int128 s = static_cast<__int128>(sqrtl(static_cast<long double>(v)));
+    while (s > 0 && s * s > v) --s;
+    while ((s + 1) * (s + 1) <= v) ++s;
+    root = s;
+    return s * s == v;
+}
+
+void sieveBlock(const SearchTask& task, const ResiduePatterns& patterns,
+                long long A64, long long B64, vector<FoundPoint>& out) {
+    const __int128 d = task.d, d2 = d * d, d4 = d2 * d2, d6 = d4 * d2;
+    const __int128 ad4 = A64 * d4, bd6 = B64 * d6;
+
+    size_t pos[SIEVE_COUNT], step[SIEVE_COUNT];
+    for (size_t s = 0; s < SIEVE_COUNT; ++s) {
+        const long long m = SIEVE_MODULI[s];
+        pos[s] = static_cast<size_t>(((task.aBegin % m) + m) % m);
+        step[s] = static_cast<size_t>(64 % m);
+    }
+
+    for (long long base = task.aBegin; base <= task.aEnd; base += 64) {
+        uint64_t live = ~uint64_t(0);
+        for (size_t s = 0; s < SIEVE_COUNT; ++s) {
+            live &= patterns.words[s][pos[s]];
+            pos[s] += step[s];
+            if (pos[s] >= static_cast<size_t>(SIEVE_MODULI[s])) pos[s] -= SIEVE_MODULI[s];
+        }
+
+        while (live) {
+            int j = __builtin_ctzll(live);
+            live &= live - 1;
+
+            long long a = base + j;
+            if (a > task.aEnd) break;
+            if (std::gcd(a < 0 ? -a : a, task.d) != 1) continue;
+
+            __int128 A128 = a;
+            __int128 v = A128 * A128 * A128 + ad4 * A128 + bd6;
+            __int128 b;
+            if (exactSquare(v, b)) out.push_back({a, task.d, b});
+        }
+    }
+}
+
+struct SearchResult {
+    vector<FoundPoint> points;
+    unsigned long long candidates = 0;
+    double seconds = 0.0;
+};
+
+/*
+ All points with naive height <= H (up to sign of y), found by numThreads
+ workers. Returns false if the curve or bound exceeds 128-bit range.
+*/
+bool searchPoints(const Curve& E, long long H, unsigned numThreads, SearchResult& result,
+                  string& error) {
+    if (!mpz_fits_slong_p(E.A.get_mpz_t()) || !mpz_fits_slong_p(E.B.get_mpz_t())) {
+        error = "curve coefficients exceed 64 bits";
+        return false;
+    }
+    const long long A64 = E.A.get_si(), B64 = E.B.get_si();
+
+    long double Hl = H;
+    long double worst = Hl * Hl * Hl + fabsl((long double)A64) * Hl * Hl * Hl + fabsl((long double)B64) * Hl * Hl * Hl;
+    if (H < 1 || worst > 1e37L) {
+        error = "height bound out of range for 128-bit arithmetic with this curve";
+        return false;
+    }
+
+    auto t0 = chrono::steady_clock::now();
+
+    vector<vector<char>> isSquare(SIEVE_COUNT);
+    for (size_t s = 0; s < SIEVE_COUNT; ++s) {
+        const int m = SIEVE_MODULI[s];
+        isSquare[s].assign(m, 0);
+        for (int r = 0; r < m; ++r) isSquare[s][r * r % m] = 1;
+    }
+
+    // Blocks of 2^22 a-values per d, dealt round-robin to the workers
+    const long long blockSize = 1LL << 22;
+    const long double root = smallestRealRoot(E);
+    WorkStealingQueues queues(numThreads);
+    size_t dealt = 0;
+
+    const long long dMax = static_cast<long long>(sqrtl(Hl));
+    for (long long d = 1; d <= dMax; ++d) {
+        long long aMin = max(-H, static_cast<long long>(floorl(root * d * d)) - 1);
+        for (long long lo = aMin; lo <= H; lo += blockSize) {
+            queues.push(dealt++ % numThreads, {d, lo, min(H, lo + blockSize - 1)});
+            result.candidates += min(H, lo + blockSize - 1) - lo + 1;
+        }
+    }
+
+    vector<vector<FoundPoint>> found(numThreads);
+    auto worker = [&](size_t id) {
+        ResiduePatterns patterns;
+        long long patternD = 0;
+        SearchTask task;
+        while (queues.next(id, task)) {
+            if (task.d != patternD) {
+                patterns.build(task.d, isSquare, A64, B64);
+                patternD = task.d;
+            }
+            sieveBlock(task, patterns, A64, B64, found[id]);
+        }
+    };
+
+    vector<thread> threads;
+    for (unsigned t = 1; t < numThreads; ++t) threads.emplace_back(worker, t);
+    worker(0);
+    for (auto& th : threads) th.join();
+
+    for (auto& f : found)
+        result.points.insert(result.points.end(), f.begin(), f.end());
+    sort(result.points.begin(), result.points.end(), [](const FoundPoint& p, const FoundPoint& q) {
+        return max<long double>(fabsl(p.a), (long double)p.d * p.d) < max<long double>(fabsl(q.a), (long double)q.d * q.d);
+    });
+
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    return true;
+}
+
+string int128ToString(__int128 v) {
+    if (v == 0) return "0";
+    bool neg = v < 0;
+    string s;
+    while (v != 0) {
+        int digit = static_cast<int>(v % 10);
+        s.push_back(static_cast<char>('0' + (neg ? -digit : digit)));
+        v /= 10;
+    }
+    if (neg) s.push_back('-');
+    return string(s.rbegin(), s.rend());
+}
+
+ECPoint toPoint(const FoundPoint& f) {
+    return ECPoint(mpz_class(to_string(f.a)), mpz_class(int128ToString(f.b)), mpz_class(to_string(f.d)));
+}
+
+/* ---------------- Curve Family Sweep ---------------- */
+
+struct SweepRow {
+    Curve curve;
+    size_t pointsFound = 0;
+    size_t rankLowerBound = 0;
+    mpf_class regulator;
+    mpf_class errorBound;
+    double seconds = 0.0;
+    string error;
+    bool done = false;
+};
+
+/*
+ Point search, heights and a greedy independent subset for one curve, all on
+ the calling thread. Points are taken in order of increasing ĥ and kept while
+ the pairing determinant stays certifiably positive, so the regulator is that
+ of the subgroup they generate (the true regulator times a square index).
+*/
+void analyseCurve(SweepRow& row, long long H, mp_bitcnt_t prec, size_t maxRank) {
+    auto t0 = chrono::steady_clock::now();
+    const Curve& E = row.curve;
+    row.regulator = mpf_class(1, prec);
+    row.errorBound = mpf_class(0, prec);
+
+    SearchResult found;
+    if (!searchPoints(E, H, 1, found, row.error)) {
+        row.seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        return;
+    }
+    row.pointsFound = found.points.size();
+
+    vector<pair<mpf_class, ECPoint>> candidates;
+    for (const FoundPoint& f : found.points) {
+        ECPoint P = toPoint(f);
+        HeightReport h = canonicalHeight(E, P, prec);
+        if (h.height > 16 * h.errorBound + mpfEpsilon(prec) * 64)   // torsion has ĥ = 0
+            candidates.emplace_back(mpf_class(h.height, prec), P);
+    }
+    sort(candidates.begin(), candidates.end(),
+         [](const auto& l, const auto& r) { return l.first < r.first; });
+
+    vector<ECPoint> basis;
+    for (const auto& c : candidates) {
+        if (basis.size() == maxRank) break;
+        basis.push_back(c.second);
+        RegulatorReport rep = computeRegulator(E, basis, 1, prec);
+        if (rep.regulator > 16 * rep.errorBound) {
+            row.regulator = rep.regulator;
+            row.errorBound = rep.errorBound;
+        } else {
+            basis.pop_back();
+        }
+    }
+    row.rankLowerBound = basis.size();
+    row.seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+/*
+ y^2 = x^3 + B for B in [bMin, bMax] (B = 0 skipped), curves handed out to
+ numThreads workers through an atomic counter. Rows are streamed to out in
+ order of B as soon as every earlier row has finished.
+*/
+void sweepFamily(long long bMin, long long bMax, long long H, unsigned numThreads,
+                 ostream& out, size_t& curvesDone) {
+    const mp_bitcnt_t prec = 128;
+    const size_t maxRank = 8;
+
+    vector<SweepRow> rows;
+    for (long long b = bMin; b <= bMax; ++b)
+        if (b != 0) {
+            rows.emplace_back();
+            rows.back().curve = {0, mpz_class(static_cast<long>(b))};
+        }
+
+    atomic<size_t> nextCurve(0);
+    mutex outMutex;
+    size_t nextToWrite = 0;
+    curvesDone = 0;
+
+    out << fixed << "B,points_found,rank_lower_bound,regulator,regulator_error,seconds,error\n";
+
+    auto worker = [&]() {
+        for (size_t k; (k = nextCurve++) < rows.size();) {
+            analyseCurve(rows[k], H, prec, maxRank);
+
+            lock_guard<mutex> lock(outMutex);
+            rows[k].done = true;
+            ++curvesDone;
+            for (; nextToWrite < rows.size() && rows[nextToWrite].done; ++nextToWrite) {
+                SweepRow& r = rows[nextToWrite];
+                out << r.curve.B << "," << r.pointsFound << "," << r.rankLowerBound << ","
+                    << setprecision(24) << r.regulator << ","
+                    << scientific << setprecision(3) << r.errorBound << ","
+                    << fixed << setprecision(6) << r.seconds << "," << r.error << "\n";
+                r.regulator = mpf_class();   // release GMP limbs of written rows
+                r.errorBound = mpf_class();
+            }
+            out.flush();
+            if (curvesDone % 100 == 0)
+                cerr << "  " << curvesDone << " / " << rows.size() << " curves\n";
+        }
+    };
+
+    vector<thread> threads;
+    for (unsigned t = 1; t < numThreads; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& th : threads) th.join();
 }
 
 /* ---------------- Main CLI Program ---------------- */
 
-int main() {
+bool readRational(const string& prompt, mpq_class& q) {
+    string text;
+    cout << prompt;
+    cin >> text;
+    if (mpq_set_str(q.get_mpq_t(), text.c_str(), 10) != 0 || q.get_den() == 0)
+        return false;
+    q.canonicalize();
+    return true;
+}
+
+void runHeightMode(const Curve& E) {
+    mpq_class x, y;
+    if (!readRational("Enter x-coordinate of point P (integer or a/b): ", x) ||
+        !readRational("Enter y-coordinate of point P (integer or a/b): ", y)) {
+        cout << "\n[ERROR] Could not parse a rational number.\n";
+        return;
+    }
+
+    ECPoint P;
+    if (!onCurve(E, x, y) || !fromAffine(x, y, P)) {
+        cout << "\n[ERROR] The point is NOT on the elliptic curve.\n";
+        cout << "Please enter a valid point.\n";
+        return;
+    }
+
+    cout << "\nComputing canonical height from local heights...\n";
+
+    auto t0 = chrono::steady_clock::now();
+    HeightReport rep = canonicalHeight(E, P);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    cout << "\n----------------------------------------------\n";
+    cout << "Canonical Height (Néron–Tate, BSD normalisation):\n";
+    cout << setprecision(36);
+    cout << "ĥ(P)         = " << rep.height << "\n";
+    cout << "  λ_∞ part   = " << rep.archimedean << "\n";
+    cout << "  Σ λ_p part = " << rep.nonArchimedean << "\n";
+    cout << scientific << setprecision(3);
+    cout << "  |error| <= " << rep.errorBound << "\n";
     cout << fixed << setprecision(18);
+    cout << "Naive height h(x(P)) = " << naiveHeight(P) << "\n";
+    for (const string& note : rep.notes)
+        cout << "  [" << note << "]\n";
+    cout << "Time: " << seconds << " s\n";
+    cout << "----------------------------------------------\n";
 
-    while (true) {
-        cout << "\n==============================================\n";
-        cout << " Birch–Swinnerton-Dyer Regulator Explorer\n";
-        cout << " Elliptic Curve: y^2 = x^3 + 7823\n";
-        cout << "==============================================\n";
+    cout << "\nThis value contributes directly to the\n";
+    cout << "Birch–Swinnerton-Dyer regulator R.\n";
+
+    string k;
+    cout << "\nExact multiple kP (enter k, or 0 to skip): ";
+    cin >> k;
+    mpz_class kk;
+    if (mpz_set_str(kk.get_mpz_t(), k.c_str(), 10) == 0 && kk != 0) {
+        t0 = chrono::steady_clock::now();
+        ECPoint kP = multiply(E, P, kk);
+        seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+        if (kP.infinity()) {
+            cout << "kP = O (point at infinity)\n";
+        } else {
+            mpq_class kx = kP.x();
+            cout << "kP: x has " << mpz_sizeinbase(kx.get_num_mpz_t(), 10)
+                 << "-digit numerator, " << mpz_sizeinbase(kx.get_den_mpz_t(), 10)
+                 << "-digit denominator\n";
+            cout << "On curve (exact check): " << (onCurve(E, kx, kP.y()) ? "yes" : "NO") << "\n";
+            if (mpz_sizeinbase(kx.get_num_mpz_t(), 10) <= 200)
+                cout << "x(kP) = " << kx << "\ny(kP) = " << kP.y() << "\n";
+        }
+        cout << "Scalar multiplication time: " << seconds << " s\n";
+    }
+}
+
+void runRegulatorMode(const Curve& E) {
+    size_t r;
+    unsigned numThreads;
+    cout << "Number of points r: ";
+    cin >> r;
+    if (r == 0 || r > 64) {
+        cout << "\n[ERROR] Between 1 and 64 points are supported.\n";
+        return;
+    }
 
-        long double x, y;
-        cout << "Enter x-coordinate of point P: ";
-        cin >> x;
+    vector<ECPoint> points;
+    for (size_t i = 0; i < r; ++i) {
+        mpq_class x, y;
+        cout << "Point P" << i + 1 << ":\n";
+        if (!readRational("  x (integer or a/b): ", x) || !readRational("  y (integer or a/b): ", y)) {
+            cout << "\n[ERROR] Could not parse a rational number.\n";
+            return;
+        }
+        ECPoint P;
+        if (!onCurve(E, x, y) || !fromAffine(x, y, P)) {
+            cout << "\n[ERROR] P" << i + 1 << " is NOT on the elliptic curve.\n";
+            return;
+        }
+        points.push_back(P);
+    }
+
+    cout << "Number of threads: ";
+    cin >> numThreads;
+    if (numThreads == 0) numThreads = max(1u, thread::hardware_concurrency());
+
+    RegulatorReport rep = computeRegulator(E, points, numThreads);
+
+    cout << "\n----------------------------------------------\n";
+    cout << "Néron–Tate pairing matrix <P_i, P_j>:\n";
+    cout << setprecision(20);
+    for (const auto& row : rep.pairing) {
+        cout << " ";
+        for (const auto& v : row) cout << " " << setw(26) << v;
+        cout << "\n";
+    }
+    cout << setprecision(36);
+    cout << "Regulator R = " << rep.regulator << "\n";
+    cout << scientific << setprecision(3);
+    cout << "Certified |error| <= " << rep.errorBound << "\n";
+    cout << fixed << setprecision(18);
+    cout << "Time: " << rep.seconds << " s on " << numThreads << " thread(s)\n";
+    cout << "----------------------------------------------\n";
+}
 
-        cout << "Enter y-coordinate of point P: ";
-        cin >> y;
+void runPointSearch(const Curve& E) {
+    long long H;
+    unsigned numThreads;
+    cout << "Naive height bound H (max(|a|, d^2) for x = a/d^2): ";
+    cin >> H;
+    cout << "Number of threads: ";
+    cin >> numThreads;
+    if (numThreads == 0) numThreads = max(1u, thread::hardware_concurrency());
 
-        long double lhs = y * y;
-        long double rhs = x * x * x + B;
+    SearchResult result;
+    string error;
+    if (!searchPoints(E, H, numThreads, result, error)) {
+        cout << "\n[ERROR] " << error << "\n";
+        return;
+    }
 
-        if (fabsl(lhs - rhs) > 1e-6L) {
-            cout << "\n[ERROR] The point is NOT on the elliptic curve.\n";
-            cout << "Please enter a valid point.\n";
-            continue;
+    cout << "\n----------------------------------------------\n";
+    cout << "Points with naive height <= " << H << " (y >= 0 shown):\n";
+    size_t shown = 0;
+    for (const FoundPoint& f : result.points) {
+        if (shown++ == 50) {
+            cout << "  ... " << result.points.size() - 50 << " more\n";
+            break;
         }
+        ECPoint P = toPoint(f);
+        HeightReport rep = canonicalHeight(E, P, 96);
+        cout << "  x = " << f.a << "/" << f.d << "^2, y = " << int128ToString(f.b) << "/" << f.d
+             << "^3   ĥ = " << setprecision(12) << rep.height << setprecision(18) << "\n";
+    }
+    cout << "Found " << result.points.size() << " point(s); " << result.candidates
+         << " candidates sieved in " << result.seconds << " s on " << numThreads << " thread(s)\n";
+    cout << "----------------------------------------------\n";
+}
+
+void runSweepMode() {
+    long long bMin, bMax, H;
+    unsigned numThreads;
+    string path;
+    cout << "Family y^2 = x^3 + B, B from: ";
+    cin >> bMin;
+    cout << "                          to: ";
+    cin >> bMax;
+    cout << "Naive height bound H per curve: ";
+    cin >> H;
+    cout << "Number of threads: ";
+    cin >> numThreads;
+    cout << "CSV output file: ";
+    cin >> path;
+    if (numThreads == 0) numThreads = max(1u, thread::hardware_concurrency());
+    if (bMin > bMax) swap(bMin, bMax);
 
-        ECPoint P(x, y);
+    ofstream out(path);
+    if (!out) {
+        cout << "\n[ERROR] Cannot open " << path << " for writing.\n";
+        return;
+    }
+
+    auto t0 = chrono::steady_clock::now();
+    size_t curves = 0;
+    sweepFamily(bMin, bMax, H, numThreads, out, curves);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
 
-        cout << "\nComputing canonical height approximation...\n";
+    cout << "\n----------------------------------------------\n";
+    cout << "Swept " << curves << " curve(s) in " << setprecision(3) << seconds << " s on "
+         << numThreads << " thread(s)" << setprecision(18) << "\n";
+    cout << "Rows written to " << path << "\n";
+    cout << "----------------------------------------------\n";
+}
 
-        long double h_hat = canonicalHeight(P);
+bool readCurve(Curve& E) {
+    string a, b;
+    cout << "Coefficients A B of y^2 = x^3 + Ax + B: ";
+    cin >> a >> b;
+    Curve C;
+    if (mpz_set_str(C.A.get_mpz_t(), a.c_str(), 10) != 0 ||
+        mpz_set_str(C.B.get_mpz_t(), b.c_str(), 10) != 0) {
+        cout << "\n[ERROR] Could not parse an integer.\n";
+        return false;
+    }
+    if (discriminant(C) == 0) {
+        cout << "\n[ERROR] The curve is singular (discriminant 0).\n";
+        return false;
+    }
+    E = C;
+    return true;
+}
+
+int main() {
+    cout << fixed << setprecision(18);
+    Curve E = DEFAULT_CURVE;
+
+    while (true) {
+        cout << "\n==============================================\n";
+        cout << " Birch–Swinnerton-Dyer Regulator Explorer\n";
+        cout << " Elliptic Curve: " << curveName(E) << "\n";
+        cout << "==============================================\n";
+        cout << "  1) Canonical height of a point\n";
+        cout << "  2) Search rational points by naive height\n";
+        cout << "  3) Regulator of r points (pairing determinant)\n";
+        cout << "  4) Sweep the family y^2 = x^3 + B over a range of B\n";
+        cout << "  5) Change the curve\n";
+        cout << "Choice: ";
 
-        cout << "\n----------------------------------------------\n";
-        cout << "Approximate Canonical Height (Néron–Tate):\n";
-        cout << "ĥ(P) ≈ " << h_hat << "\n";
-        cout << "----------------------------------------------\n";
+        int mode;
+        cin >> mode;
+        if (!cin) break;
 
-        cout << "\nThis value contributes directly to the\n";
-        cout << "Birch–Swinnerton-Dyer regulator R.\n";
+        if (mode == 2)
+            runPointSearch(E);
+        else if (mode == 3)
+            runRegulatorMode(E);
+        else if (mode == 4)
+            runSweepMode();
+        else if (mode == 5)
+            readCurve(E);
+        else
+            runHeightMode(E);
 
         char choice;
-        cout << "\nWould you like to compute another point? (y/n): ";
+        cout << "\nWould you like to continue exploring? (y/n): ";
         cin >> choice;
 
         if (choice != 'y' && choice != 'Y') {
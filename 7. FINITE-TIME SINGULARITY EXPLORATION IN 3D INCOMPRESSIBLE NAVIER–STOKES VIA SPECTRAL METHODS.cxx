@@ -13,153 +13,1686 @@
 #include <cmath>
 #include <iomanip>
 #include <limits>
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <string>
+#include <cstdint>
+#include <type_traits>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__SSE3__) || defined(__x86_64__)
+#include <pmmintrin.h>
+#endif
+#ifdef NS_USE_MPI
+#include <mpi.h>
+#endif
 
 using Real = double;
 using Complex = std::complex<Real>;
 
 constexpr Real PI = 3.14159265358979323846;
 
+// ------------------------------------------------------------
+// Precision Policies
+// ------------------------------------------------------------
+// Store is the type of every grid-sized array; Accum is used for FFT
+// butterflies, nonlinear products, the ETDRK4 running sum and all
+// diagnostic sums. Mixed halves memory and bandwidth against Double
+// while keeping the sums in double.
+template <class StoreT, class AccumT>
+struct PrecisionPolicy {
+    using Store = StoreT;
+    using Accum = AccumT;
+};
+
+using DoublePrecision = PrecisionPolicy<double, double>;
+using MixedPrecision  = PrecisionPolicy<float, double>;
+using SinglePrecision = PrecisionPolicy<float, float>;
+
+enum class Precision : std::int32_t { Double = 0, Mixed = 1, Single = 2 };
+
+inline const char* precisionName(Precision p) {
+    switch (p) {
+        case Precision::Mixed:  return "float storage / double sums";
+        case Precision::Single: return "float";
+        default:                return "double";
+    }
+}
+
+// ------------------------------------------------------------
+// Threading and First-Touch Storage
+// ------------------------------------------------------------
+// Spectral tails decay below the float normal range long before they
+// matter, and denormal arithmetic is ~100x slower on x86; flush them.
+inline void flushDenormals() {
+#if defined(__SSE3__) || defined(__x86_64__)
+    _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+#endif
+}
+
+// body(thread, begin, end) on a static partition of [0, n). Every pass
+// over the x index uses the same partition, so the thread that first
+// touched a slab keeps working on it and its pages stay NUMA-local.
+template <class Body>
+void parallelSlabs(int threads, int n, Body&& body) {
+    if (threads <= 1) {
+        body(0, 0, n);
+        return;
+    }
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t)
+        pool.emplace_back([&body, t, threads, n] {
+            flushDenormals();
+            body(t, n * t / threads, n * (t + 1) / threads);
+        });
+    body(0, 0, n / threads);
+    for (auto& th : pool) th.join();
+}
+
+// Leaves elements uninitialised so the first write decides page placement
+template <class T>
+struct FirstTouchAllocator {
+    using value_type = T;
+
+    FirstTouchAllocator() = default;
+    template <class U> FirstTouchAllocator(const FirstTouchAllocator<U>&) {}
+
+    T* allocate(std::size_t n) { return std::allocator<T>().allocate(n); }
+    void deallocate(T* p, std::size_t n) { std::allocator<T>().deallocate(p, n); }
+
+    template <class U> void construct(U*) {}
+    template <class U, class... Args> void construct(U* p, Args&&... args) {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+    template <class U> bool operator==(const FirstTouchAllocator<U>&) const { return true; }
+    template <class U> bool operator!=(const FirstTouchAllocator<U>&) const { return false; }
+};
+
+template <class T>
+using Array = std::vector<T, FirstTouchAllocator<T>>;
+
+// Split real/imaginary (SoA) storage: every kernel streams unit-stride
+// arrays, which the compiler vectorises without shuffles.
+template <class T>
+struct SpectralField {
+    Array<T> re;
+    Array<T> im;
+
+    SpectralField() = default;
+    explicit SpectralField(std::size_t n) : re(n), im(n) {}
+
+    void resize(std::size_t n) { re.resize(n); im.resize(n); }
+    std::size_t size() const { return re.size(); }
+};
+
+// Zero a field of n x-planes from the threads that will own them
+template <class T>
+void firstTouch(Array<T>& f, int threads, int n) {
+    std::size_t plane = f.size() / n;
+    parallelSlabs(threads, n, [&](int, int begin, int end) {
+        std::fill(f.begin() + begin * plane, f.begin() + end * plane, T(0));
+    });
+}
+
+template <class T>
+void firstTouch(SpectralField<T>& f, int threads, int n) {
+    firstTouch(f.re, threads, n);
+    firstTouch(f.im, threads, n);
+}
+
+// ------------------------------------------------------------
+// Process Grid (MPI pencil decomposition)
+// ------------------------------------------------------------
+// Built with mpicxx -DNS_USE_MPI and started under mpirun, the ranks form
+// a rows x cols grid. Physical fields are z-pencils (x split over rows,
+// y over cols); spectral fields are x-pencils (ky split over rows, kz over
+// cols). Without NS_USE_MPI there is a single rank and every collective
+// below is a no-op, so the solver runs exactly as before.
+
+// Block [begin, begin + count) of n items owned by part p of parts
+struct Range {
+    int begin = 0;
+    int count = 0;
+    int end() const { return begin + count; }
+};
+
+inline Range blockRange(int n, int parts, int p) {
+    int begin = static_cast<int>(std::int64_t(n) * p / parts);
+    int end = static_cast<int>(std::int64_t(n) * (p + 1) / parts);
+    return { begin, end - begin };
+}
+
+#ifdef NS_USE_MPI
+template <class T> MPI_Datatype mpiType();
+template <> inline MPI_Datatype mpiType<float>() { return MPI_FLOAT; }
+template <> inline MPI_Datatype mpiType<double>() { return MPI_DOUBLE; }
+#endif
+
+// Collectives over all ranks
+struct World {
+    static int rank() {
+        int r = 0;
+#ifdef NS_USE_MPI
+        MPI_Comm_rank(MPI_COMM_WORLD, &r);
+#endif
+        return r;
+    }
+
+    static int size() {
+        int n = 1;
+#ifdef NS_USE_MPI
+        MPI_Comm_size(MPI_COMM_WORLD, &n);
+#endif
+        return n;
+    }
+
+    static bool root() { return rank() == 0; }
+
+    // True on every rank iff ok on every rank
+    static bool all(bool ok) {
+        int flag = ok ? 1 : 0;
+#ifdef NS_USE_MPI
+        MPI_Allreduce(MPI_IN_PLACE, &flag, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+#endif
+        return flag != 0;
+    }
+
+    static void sum(Real* values, int n) {
+#ifdef NS_USE_MPI
+        MPI_Allreduce(MPI_IN_PLACE, values, n, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+#else
+        (void)values;
+        (void)n;
+#endif
+    }
+
+    static Real max(Real value) {
+#ifdef NS_USE_MPI
+        MPI_Allreduce(MPI_IN_PLACE, &value, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+#endif
+        return value;
+    }
+
+    // Rank 0's value everywhere
+    template <class T>
+    static void broadcast(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "broadcast copies bytes");
+#ifdef NS_USE_MPI
+        MPI_Bcast(&value, sizeof(T), MPI_BYTE, 0, MPI_COMM_WORLD);
+#else
+        (void)value;
+#endif
+    }
+
+    static void broadcast(std::string& s) {
+        std::uint64_t n = s.size();
+        broadcast(n);
+        s.resize(n);
+#ifdef NS_USE_MPI
+        MPI_Bcast(&s[0], static_cast<int>(n), MPI_CHAR, 0, MPI_COMM_WORLD);
+#endif
+    }
+};
+
+// Standard output on rank 0, discarded on the others
+inline std::ostream& console() {
+    static std::ostream discard(nullptr);
+    return World::root() ? std::cout : discard;
+}
+
+class ProcessGrid {
+public:
+    // Ranks sharing this rank's row (cols of them) or column (rows of them)
+    enum Group { SameRow, SameColumn };
+
+    int rows = 1, cols = 1;
+    int row = 0, col = 0;
+
+    ProcessGrid() {
+#ifdef NS_USE_MPI
+        int dims[2] = { 0, 0 };
+        MPI_Dims_create(World::size(), 2, dims);
+        cols = dims[0];
+        rows = dims[1];
+        row = World::rank() / cols;
+        col = World::rank() % cols;
+        MPI_Comm_split(MPI_COMM_WORLD, row, col, &rowComm);
+        MPI_Comm_split(MPI_COMM_WORLD, col, row, &colComm);
+#endif
+    }
+
+    ProcessGrid(const ProcessGrid&) = delete;
+    ProcessGrid& operator=(const ProcessGrid&) = delete;
+
+    ~ProcessGrid() {
+#ifdef NS_USE_MPI
+        MPI_Comm_free(&rowComm);
+        MPI_Comm_free(&colComm);
+#endif
+    }
+
+    // Every rank needs at least one x plane, y row and kz mode
+    bool fits(int N) const { return rows <= N && cols <= N/2 + 1; }
+
+    int groupSize(Group g) const { return g == SameRow ? cols : rows; }
+    int groupRank(Group g) const { return g == SameRow ? col : row; }
+
+    // counts[r] values go to / come from group rank r, packed in rank order
+    template <class T>
+    void allToAll(Group g, const T* send, const std::vector<int>& sendCounts,
+                  T* recv, const std::vector<int>& recvCounts) const {
+#ifdef NS_USE_MPI
+        std::vector<int> sendOffsets(sendCounts.size(), 0), recvOffsets(recvCounts.size(), 0);
+        for (std::size_t r = 1; r < sendCounts.size(); ++r) {
+            sendOffsets[r] = sendOffsets[r - 1] + sendCounts[r - 1];
+            recvOffsets[r] = recvOffsets[r - 1] + recvCounts[r - 1];
+        }
+        MPI_Alltoallv(send, sendCounts.data(), sendOffsets.data(), mpiType<T>(),
+                      recv, recvCounts.data(), recvOffsets.data(), mpiType<T>(),
+                      g == SameRow ? rowComm : colComm);
+#else
+        (void)g;
+        (void)recvCounts;
+        std::copy(send, send + sendCounts[0], recv);
+#endif
+    }
+
+private:
+#ifdef NS_USE_MPI
+    MPI_Comm rowComm = MPI_COMM_NULL;
+    MPI_Comm colComm = MPI_COMM_NULL;
+#endif
+};
+
 // ------------------------------------------------------------
 // Spectral Grid Structure
 // ------------------------------------------------------------
+// Velocity is real, so only the half spectrum kz = 0..N/2 is stored;
+// the remaining modes follow from u_hat(-k) = conj(u_hat(k)).
+//
+// Each rank stores the spectral modes with ky in ky and kz in kz (all kx)
+// and the physical points with x in px and y in py (all z). All indices
+// passed to idx and realIdx are global.
+template <class P>
 struct SpectralGrid {
+    using Store = typename P::Store;
+
     int N;
+    int Nh;     // N/2 + 1 stored kz modes
     Real L;
     Real viscosity;
+    int threads;
+
+    const ProcessGrid& procs;
+    Range ky, kz;   // spectral ownership
+    Range px, py;   // physical ownership
+
+    SpectralField<Store> u_hat_x;
+    SpectralField<Store> u_hat_y;
+    SpectralField<Store> u_hat_z;
+
+    SpectralGrid(int n, Real domain, Real nu, int nThreads, const ProcessGrid& grid)
+        : N(n), Nh(n/2 + 1), L(domain), viscosity(nu), threads(nThreads), procs(grid),
+          ky(blockRange(n, grid.rows, grid.row)), kz(blockRange(n/2 + 1, grid.cols, grid.col)),
+          px(blockRange(n, grid.rows, grid.row)), py(blockRange(n, grid.cols, grid.col)),
+          u_hat_x(spectralSize()), u_hat_y(spectralSize()), u_hat_z(spectralSize()) {
+        firstTouch(u_hat_x, threads, N);
+        firstTouch(u_hat_y, threads, N);
+        firstTouch(u_hat_z, threads, N);
+    }
+
+    // Values held by this rank in spectral and physical space
+    std::size_t spectralSize() const { return std::size_t(N) * ky.count * kz.count; }
+    std::size_t physicalSize() const { return std::size_t(px.count) * py.count * N; }
+
+    // Spectral index, kz in [0, N/2]
+    inline std::size_t idx(int i, int j, int k) const {
+        return (std::size_t(i) * ky.count + (j - ky.begin)) * kz.count + (k - kz.begin);
+    }
+
+    // Physical index on the N^3 collocation grid
+    inline std::size_t realIdx(int i, int j, int k) const {
+        return (std::size_t(i - px.begin) * py.count + (j - py.begin)) * N + k;
+    }
+
+    // |signed index| of FFT index i along x or y
+    inline int mode(int i) const {
+        return (i <= N/2) ? i : N - i;
+    }
+
+    // Signed wavenumber of FFT index i along x or y
+    inline Real wavenumber(int i) const {
+        return Real((i <= N/2) ? i : i - N) * (2 * PI / L);
+    }
+
+    // 2/3 rule: keep modes with every |k_d| <= N/3
+    inline bool resolved(int i, int j, int k) const {
+        return 3 * mode(i) <= N && 3 * mode(j) <= N && 3 * k <= N;
+    }
+
+    // Modes 0 < kz < N/2 stand for themselves and their conjugate
+    inline Real multiplicity(int k) const {
+        return (k == 0 || 2 * k == N) ? 1.0 : 2.0;
+    }
+};
+
+// ------------------------------------------------------------
+// FFT Plan (twiddles and bit reversal, built once per N)
+// ------------------------------------------------------------
+struct FFTPlan {
+    int N;
+    std::vector<Complex> twiddle;    // exp(-2 pi i m / N), m < N/2
+    std::vector<int> reverseN;       // bit reversal for length N
+    std::vector<int> reverseM;       // and for length N/2
+
+    explicit FFTPlan(int n) : N(n), twiddle(n/2) {
+        for (int m = 0; m < n/2; ++m)
+            twiddle[m] = std::polar(Real(1), -2 * PI * m / n);
+        reverseN = bitReversal(n);
+        reverseM = bitReversal(n/2);
+    }
+
+    static std::vector<int> bitReversal(int n) {
+        std::vector<int> r(n, 0);
+        for (int i = 1, j = 0; i < n; ++i) {
+            int bit = n >> 1;
+            for (; j & bit; bit >>= 1) j ^= bit;
+            j ^= bit;
+            r[i] = j;
+        }
+        return r;
+    }
+
+    static std::shared_ptr<const FFTPlan> get(int n) {
+        static std::mutex lock;
+        static std::map<int, std::shared_ptr<const FFTPlan>> cache;
+        std::lock_guard<std::mutex> guard(lock);
+        auto& plan = cache[n];
+        if (!plan) plan = std::make_shared<const FFTPlan>(n);
+        return plan;
+    }
+};
+
+// ------------------------------------------------------------
+// Real-to-Complex 3D FFT (radix-2, pencil-decomposed, threaded)
+// ------------------------------------------------------------
+// Forward: z lines of the physical z-pencils, transpose within the row
+// to y-pencils, y columns, transpose within the column to x-pencils, x
+// columns. The inverse runs the same passes backwards. With one rank per
+// row (column) the first (second) transpose is skipped and its pencils
+// alias, so a single process transforms in place as a slab code would.
+//
+// Within a rank, every pass is split over the threads by an outer index.
+// Columns are moved through a per-thread buffer COLUMNS wide, so every
+// butterfly works on contiguous rows that stay in cache. Butterflies run
+// in the accumulation type; only the stored arrays use the storage type.
+template <class P>
+class FFT3D {
+public:
+    using Store = typename P::Store;
+    using Accum = typename P::Accum;
+    using Cplx = std::complex<Accum>;
+
+    static constexpr int COLUMNS = 16;
+
+    explicit FFT3D(const SpectralGrid<P>& grid)
+        : N(grid.N), M(grid.N/2), Nh(grid.Nh), threads(grid.threads), procs(grid.procs),
+          px(grid.px), py(grid.py), ky(grid.ky), kz(grid.kz),
+          plan(FFTPlan::get(grid.N)),
+          twiddle(plan->twiddle.begin(), plan->twiddle.end()),
+          spectrum(grid.spectralSize()), scratch(grid.threads) {
+        for (int r = 0; r < procs.rows; ++r) {
+            xRanges.push_back(blockRange(N, procs.rows, r));
+            kyRanges.push_back(blockRange(N, procs.rows, r));
+        }
+        for (int r = 0; r < procs.cols; ++r) {
+            yRanges.push_back(blockRange(N, procs.cols, r));
+            kzRanges.push_back(blockRange(Nh, procs.cols, r));
+        }
+
+        firstTouch(spectrum, threads, N);
+        std::size_t zSize = std::size_t(px.count) * py.count * Nh;
+        std::size_t ySize = std::size_t(px.count) * N * kz.count;
+        if (procs.cols > 1) {
+            zPencil.resize(zSize);
+            firstTouch(zPencil, threads, px.count);
+        }
+        if (procs.rows > 1) {
+            yPencil.resize(ySize);
+            firstTouch(yPencil, threads, px.count);
+        }
+        if (procs.rows > 1 || procs.cols > 1) {
+            std::size_t most = 2 * std::max({ zSize, ySize, spectrum.size() });
+            sendBuffer.resize(most);
+            recvBuffer.resize(most);
+        }
+        parallelSlabs(threads, threads, [&](int t, int, int) {
+            scratch[t].assign(std::size_t(N) * COLUMNS, Cplx(0));
+        });
+    }
+
+    // Physical z-pencil -> Fourier coefficients (scaled by 1/N^3)
+    void forward(const Store* in, SpectralField<Store>& out) {
+        const Accum scale = Accum(1) / (Accum(N) * N * N);
+        SpectralField<Store>& y = (procs.rows > 1) ? yPencil : out;
+        SpectralField<Store>& z = (procs.cols > 1) ? zPencil : y;
+        const bool fused = procs.cols == 1;
+
+        parallelSlabs(threads, px.count, [&](int t, int begin, int end) {
+            Cplx* buf = scratch[t].data();
+            for (int i = begin; i < end; ++i) {
+                for (int j = 0; j < py.count; ++j) {
+                    std::size_t line = std::size_t(i) * py.count + j;
+                    realForward(in + line * N, z.re.data() + line * Nh, z.im.data() + line * Nh, buf);
+                }
+                if (fused) yColumns(y, i, false, buf);
+            }
+        });
+
+        if (!fused) {
+            transpose(ProcessGrid::SameRow, z, y, px.count, 1, yRanges, kzRanges, false);
+            parallelSlabs(threads, px.count, [&](int t, int begin, int end) {
+                for (int i = begin; i < end; ++i) yColumns(y, i, false, scratch[t].data());
+            });
+        }
+
+        if (procs.rows > 1)
+            transpose(ProcessGrid::SameColumn, y, out, 1, kz.count, xRanges, kyRanges, false);
+
+        const std::size_t stride = std::size_t(ky.count) * kz.count;
+        parallelSlabs(threads, ky.count, [&](int t, int begin, int end) {
+            Cplx* buf = scratch[t].data();
+            for (int j = begin; j < end; ++j)
+                for (int k = 0; k < kz.count; k += COLUMNS) {
+                    std::size_t col = std::size_t(j) * kz.count + k;
+                    Store* re = out.re.data() + col;
+                    Store* im = out.im.data() + col;
+                    columns(re, im, re, im, stride, std::min(COLUMNS, kz.count - k), false, scale, buf);
+                }
+        });
+    }
+
+    // Fourier coefficients -> physical z-pencil (unnormalised synthesis)
+    void inverse(const SpectralField<Store>& in, Store* out) {
+        SpectralField<Store>& y = (procs.rows > 1) ? yPencil : spectrum;
+        SpectralField<Store>& z = (procs.cols > 1) ? zPencil : y;
+        const bool fused = procs.cols == 1;
+
+        const std::size_t stride = std::size_t(ky.count) * kz.count;
+        parallelSlabs(threads, ky.count, [&](int t, int begin, int end) {
+            Cplx* buf = scratch[t].data();
+            for (int j = begin; j < end; ++j)
+                for (int k = 0; k < kz.count; k += COLUMNS) {
+                    std::size_t col = std::size_t(j) * kz.count + k;
+                    columns(in.re.data() + col, in.im.data() + col, spectrum.re.data() + col,
+                            spectrum.im.data() + col, stride, std::min(COLUMNS, kz.count - k),
+                            true, 1, buf);
+                }
+        });
+
+        if (procs.rows > 1)
+            transpose(ProcessGrid::SameColumn, spectrum, y, 1, kz.count, xRanges, kyRanges, true);
+
+        if (!fused) {
+            parallelSlabs(threads, px.count, [&](int t, int begin, int end) {
+                for (int i = begin; i < end; ++i) yColumns(y, i, true, scratch[t].data());
+            });
+            transpose(ProcessGrid::SameRow, y, z, px.count, 1, yRanges, kzRanges, true);
+        }
+
+        parallelSlabs(threads, px.count, [&](int t, int begin, int end) {
+            Cplx* buf = scratch[t].data();
+            for (int i = begin; i < end; ++i) {
+                if (fused) yColumns(y, i, true, buf);
+                for (int j = 0; j < py.count; ++j) {
+                    std::size_t line = std::size_t(i) * py.count + j;
+                    realInverse(z.re.data() + line * Nh, z.im.data() + line * Nh, out + line * N, buf);
+                }
+            }
+        });
+    }
+
+private:
+    int N, M, Nh;
+    int threads;
+    const ProcessGrid& procs;
+    Range px, py, ky, kz;
+    std::vector<Range> xRanges, yRanges, kyRanges, kzRanges;   // per group rank
+    std::shared_ptr<const FFTPlan> plan;
+    std::vector<Cplx> twiddle;                 // plan twiddles in Accum
+    SpectralField<Store> spectrum;             // inverse works out of place
+    SpectralField<Store> zPencil;              // px x py x Nh, if cols > 1
+    SpectralField<Store> yPencil;              // px x N x kz, if rows > 1
+    std::vector<Store> sendBuffer, recvBuffer;
+    std::vector<std::vector<Cplx>> scratch;    // one column block per thread
+
+    // The y columns of x-plane i of a y-pencil
+    void yColumns(SpectralField<Store>& y, int i, bool inv, Cplx* buf) const {
+        const std::size_t plane = std::size_t(i) * N * kz.count;
+        for (int k = 0; k < kz.count; k += COLUMNS) {
+            Store* re = y.re.data() + plane + k;
+            Store* im = y.im.data() + plane + k;
+            columns(re, im, re, im, kz.count, std::min(COLUMNS, kz.count - k), inv, 1, buf);
+        }
+    }
+
+    // Pencil transpose within a process group. The narrow-b layout is
+    // [A][b][C][D] with b this rank's share of B and C complete; the
+    // narrow-c layout is [A][B][c][D]. Forward sends narrow-b src to
+    // narrow-c dst; back goes the other way. Both channels of a block
+    // travel in one message, re before im.
+    void transpose(ProcessGrid::Group g, const SpectralField<Store>& src, SpectralField<Store>& dst,
+                   int A, int D, const std::vector<Range>& bRanges,
+                   const std::vector<Range>& cRanges, bool back) {
+        const int ranks = procs.groupSize(g);
+        const Range b = bRanges[procs.groupRank(g)], c = cRanges[procs.groupRank(g)];
+        const int B = bRanges.back().end(), C = cRanges.back().end();
+
+        // visit(offset, length) for the runs of a narrow-b array with c in cr
+        auto narrowB = [&](Range cr, auto&& visit) {
+            for (int a = 0; a < A; ++a)
+                for (int l = 0; l < b.count; ++l)
+                    visit(((std::size_t(a) * b.count + l) * C + cr.begin) * D, std::size_t(cr.count) * D);
+        };
+        // ... and of a narrow-c array with b in br
+        auto narrowC = [&](Range br, auto&& visit) {
+            for (int a = 0; a < A; ++a)
+                for (int l = br.begin; l < br.end(); ++l)
+                    visit((std::size_t(a) * B + l) * c.count * D, std::size_t(c.count) * D);
+        };
+        // Values of one channel exchanged with group rank r
+        auto sendCount = [&](int r) {
+            return back ? std::size_t(A) * bRanges[r].count * c.count * D
+                        : std::size_t(A) * b.count * cRanges[r].count * D;
+        };
+        auto recvCount = [&](int r) {
+            return back ? std::size_t(A) * b.count * cRanges[r].count * D
+                        : std::size_t(A) * bRanges[r].count * c.count * D;
+        };
+
+        std::vector<int> sendCounts(ranks), recvCounts(ranks);
+        Store* block = sendBuffer.data();
+        for (int r = 0; r < ranks; ++r) {
+            std::size_t n = sendCount(r);
+            Store *re = block, *im = block + n;
+            auto pack = [&](std::size_t at, std::size_t run) {
+                re = std::copy(src.re.data() + at, src.re.data() + at + run, re);
+                im = std::copy(src.im.data() + at, src.im.data() + at + run, im);
+            };
+            if (back) narrowC(bRanges[r], pack);
+            else narrowB(cRanges[r], pack);
+            sendCounts[r] = static_cast<int>(2 * n);
+            recvCounts[r] = static_cast<int>(2 * recvCount(r));
+            block += 2 * n;
+        }
+
+        procs.allToAll(g, sendBuffer.data(), sendCounts, recvBuffer.data(), recvCounts);
+
+        block = recvBuffer.data();
+        for (int r = 0; r < ranks; ++r) {
+            std::size_t n = recvCount(r);
+            const Store *re = block, *im = block + n;
+            auto unpack = [&](std::size_t at, std::size_t run) {
+                std::copy(re, re + run, dst.re.data() + at);
+                std::copy(im, im + run, dst.im.data() + at);
+                re += run;
+                im += run;
+            };
+            if (back) narrowB(cRanges[r], unpack);
+            else narrowC(bRanges[r], unpack);
+            block += 2 * n;
+        }
+    }
+
+    // In-place radix-2 transform of `width` interleaved sequences of length n
+    void fft(Cplx* a, int n, int width, bool inv) const {
+        const std::vector<int>& reverse = (n == N) ? plan->reverseN : plan->reverseM;
+        for (int i = 1; i < n; ++i)
+            if (i < reverse[i])
+                std::swap_ranges(a + i * width, a + (i + 1) * width, a + reverse[i] * width);
+
+        for (int len = 2; len <= n; len <<= 1) {
+            int step = N / len;
+            for (int s = 0; s < n; s += len)
+                for (int m = 0; m < len/2; ++m) {
+                    // Spelled out in reals: std::complex operator* adds
+                    // NaN recovery branches that block vectorisation
+                    const Accum wr = twiddle[m * step].real();
+                    const Accum wi = inv ? -twiddle[m * step].imag() : twiddle[m * step].imag();
+                    Accum* p = reinterpret_cast<Accum*>(a + (s + m) * width);
+                    Accum* q = reinterpret_cast<Accum*>(a + (s + m + len/2) * width);
+                    for (int b = 0; b < 2 * width; b += 2) {
+                        Accum tr = q[b] * wr - q[b + 1] * wi;
+                        Accum ti = q[b] * wi + q[b + 1] * wr;
+                        q[b] = p[b] - tr;
+                        q[b + 1] = p[b + 1] - ti;
+                        p[b] += tr;
+                        p[b + 1] += ti;
+                    }
+                }
+        }
+    }
+
+    // Transform `width` adjacent columns of N rows spaced `stride` apart
+    void columns(const Store* srcRe, const Store* srcIm, Store* dstRe, Store* dstIm,
+                 std::size_t stride, int width, bool inv, Accum scale, Cplx* buf) const {
+        for (int n = 0; n < N; ++n)
+            for (int b = 0; b < width; ++b)
+                buf[n * width + b] = Cplx(srcRe[n * stride + b], srcIm[n * stride + b]);
+        fft(buf, N, width, inv);
+        for (int n = 0; n < N; ++n)
+            for (int b = 0; b < width; ++b) {
+                dstRe[n * stride + b] = Store(buf[n * width + b].real() * scale);
+                dstIm[n * stride + b] = Store(buf[n * width + b].imag() * scale);
+            }
+    }
+
+    // N real samples -> N/2 + 1 coefficients via one complex FFT of length N/2
+    void realForward(const Store* x, Store* re, Store* im, Cplx* line) const {
+        for (int n = 0; n < M; ++n) line[n] = Cplx(x[2*n], x[2*n + 1]);
+        fft(line, M, 1, false);
+
+        re[0] = Store(line[0].real() + line[0].imag());
+        re[M] = Store(line[0].real() - line[0].imag());
+        im[0] = im[M] = 0;
+        // X = ((a + b) - i W^k (a - b)) / 2 with a = Z[k], b = conj(Z[M - k])
+        for (int k = 1; k < M; ++k) {
+            Accum ar = line[k].real(), ai = line[k].imag();
+            Accum br = line[M - k].real(), bi = -line[M - k].imag();
+            Accum wr = twiddle[k].real(), wi = twiddle[k].imag();
+            Accum dr = ar - br, di = ai - bi;
+            re[k] = Store(Accum(0.5) * (ar + br + wr * di + wi * dr));
+            im[k] = Store(Accum(0.5) * (ai + bi - wr * dr + wi * di));
+        }
+    }
 
-    std::vector<Complex> u_hat_x;
-    std::vector<Complex> u_hat_y;
-    std::vector<Complex> u_hat_z;
+    void realInverse(const Store* re, const Store* im, Store* x, Cplx* line) const {
+        // Z[k] = (a + b) + i conj(W^k) (a - b) with a = X[k], b = conj(X[M - k])
+        for (int k = 0; k < M; ++k) {
+            Accum ar = re[k], ai = im[k], br = re[M - k], bi = -Accum(im[M - k]);
+            Accum wr = twiddle[k].real(), wi = twiddle[k].imag();
+            Accum dr = ar - br, di = ai - bi;
+            line[k] = Cplx(ar + br - wr * di + wi * dr, ai + bi + wr * dr + wi * di);
+        }
+        fft(line, M, 1, true);
+        for (int n = 0; n < M; ++n) {
+            x[2*n] = Store(line[n].real());
+            x[2*n + 1] = Store(line[n].imag());
+        }
+    }
+};
+
+// ------------------------------------------------------------
+// ETDRK4 Coefficients (one entry per integer shell |k|^2)
+// ------------------------------------------------------------
+// Linear part L = -nu |k|^2 depends on the mode only through the shell
+// m = kx^2 + ky^2 + kz^2 in index units, so 3 (N/2)^2 + 1 entries cover
+// the grid. The phi-functions are evaluated by the Kassam–Trefethen
+// contour mean, which stays accurate as hL -> 0. Tables are always built
+// in double and rounded once to the accumulation type.
+template <class Accum>
+struct ETDCoefficients {
+    Real dt = 0;
+    std::vector<Accum> E, E2, Q, f1, f2, f3;
+
+    template <class Grid>
+    void prepare(const Grid& grid, Real h) {
+        if (h == dt && !E.empty()) return;
+        dt = h;
 
-    SpectralGrid(int n, Real domain, Real nu)
-        : N(n), L(domain), viscosity(nu),
-          u_hat_x(n*n*n), u_hat_y(n*n*n), u_hat_z(n*n*n) {}
+        const int shells = 3 * (grid.N/2) * (grid.N/2) + 1;
+        const Real k0 = 2 * PI / grid.L;
+        const int contour = 32;
+        for (auto* v : { &E, &E2, &Q, &f1, &f2, &f3 }) v->resize(shells);
 
-    inline int idx(int i, int j, int k) const {
-        return (i * N + j) * N + k;
+        for (int m = 0; m < shells; ++m) {
+            Real hL = -grid.viscosity * m * k0 * k0 * h;
+            Complex q = 0, a = 0, b = 0, c = 0;
+            for (int j = 0; j < contour; ++j) {
+                Complex z = hL + std::polar(Real(1), PI * (j + Real(0.5)) / contour);
+                Complex ez = std::exp(z), z3 = z * z * z;
+                q += (std::exp(z / Real(2)) - Real(1)) / z;
+                a += (Real(-4) - z + ez * (Real(4) - Real(3) * z + z * z)) / z3;
+                b += (Real(2) + z + ez * (z - Real(2))) / z3;
+                c += (Real(-4) - Real(3) * z - z * z + ez * (Real(4) - z)) / z3;
+            }
+            E[m] = Accum(std::exp(hL));
+            E2[m] = Accum(std::exp(hL / 2));
+            Q[m] = Accum(h * q.real() / contour);
+            f1[m] = Accum(h * a.real() / contour);
+            f2[m] = Accum(h * b.real() / contour);
+            f3[m] = Accum(h * c.real() / contour);
+        }
+    }
+};
+
+// ------------------------------------------------------------
+// Flow Diagnostics
+// ------------------------------------------------------------
+struct FlowDiagnostics {
+    Real energy = 0;              // (1/2) <|u|^2>
+    Real enstrophy = 0;           // (1/2) <|omega|^2>
+    Real maxVorticity = 0;        // max |omega| on the collocation grid
+    Real maxSpeed = 0;            // max |ux| + |uy| + |uz|
+    std::vector<Real> spectrum;   // E(k): shells round(|k|) = k, index units
+};
+
+// ------------------------------------------------------------
+// Solver Workspace (physical fields and Runge–Kutta stages)
+// ------------------------------------------------------------
+// Everything the size of the grid is kept in the storage type except the
+// running ETDRK4 sum, which collects four stages and so is accumulated.
+template <class P>
+struct SolverWorkspace {
+    using Store = typename P::Store;
+    using Accum = typename P::Accum;
+
+    FFT3D<P> fft;
+    ETDCoefficients<Accum> etd;
+    Array<Store> u[3];                 // velocity on the collocation grid
+    Array<Store> w[3];                 // vorticity, then u x omega
+    SpectralField<Store> spec;         // one spectral component
+    SpectralField<Store> rhs[3];       // N(u_n), then the partial stage c
+    SpectralField<Store> stage[3];     // stages a, b, c and their nonlinear terms
+    SpectralField<Accum> acc[3];       // running ETDRK4 update
+    std::vector<int> shellBin;         // round(sqrt(m)) for each shell m
+    std::vector<Accum> weight;         // multiplicity of each stored kz
+
+    explicit SolverWorkspace(const SpectralGrid<P>& grid)
+        : fft(grid), spec(grid.spectralSize()),
+          shellBin(3 * (grid.N/2) * (grid.N/2) + 1), weight(grid.Nh) {
+        firstTouch(spec, grid.threads, grid.N);
+        for (int c = 0; c < 3; ++c) {
+            u[c].resize(grid.physicalSize());
+            w[c].resize(grid.physicalSize());
+            rhs[c].resize(spec.size());
+            stage[c].resize(spec.size());
+            acc[c].resize(spec.size());
+            firstTouch(u[c], grid.threads, grid.px.count);
+            firstTouch(w[c], grid.threads, grid.px.count);
+            firstTouch(rhs[c], grid.threads, grid.N);
+            firstTouch(stage[c], grid.threads, grid.N);
+            firstTouch(acc[c], grid.threads, grid.N);
+        }
+        for (std::size_t m = 0; m < shellBin.size(); ++m)
+            shellBin[m] = static_cast<int>(std::sqrt(Real(m)) + Real(0.5));
+        for (int k = 0; k < grid.Nh; ++k)
+            weight[k] = Accum(grid.multiplicity(k));
     }
 };
 
 // ------------------------------------------------------------
 // Initial Condition (High-Energy Vortex Configuration)
 // ------------------------------------------------------------
-void initializeTaylorGreenVortex(SpectralGrid& grid) {
-    for (int i = 0; i < grid.N; ++i)
-        for (int j = 0; j < grid.N; ++j)
-            for (int k = 0; k < grid.N; ++k) {
+template <class P>
+void initializeTaylorGreenVortex(SpectralGrid<P>& grid, SolverWorkspace<P>& ws) {
+    using Store = typename P::Store;
+    parallelSlabs(grid.threads, grid.px.count, [&](int, int begin, int end) {
+        for (int i = grid.px.begin + begin; i < grid.px.begin + end; ++i)
+            for (int j = grid.py.begin; j < grid.py.end(); ++j)
+                for (int k = 0; k < grid.N; ++k) {
+
+                    Real x = 2 * PI * i / grid.N;
+                    Real y = 2 * PI * j / grid.N;
+                    Real z = 2 * PI * k / grid.N;
+
+                    std::size_t id = grid.realIdx(i,j,k);
+
+                    ws.u[0][id] = Store(std::sin(x) * std::cos(y) * std::cos(z));
+                    ws.u[1][id] = Store(-std::cos(x) * std::sin(y) * std::cos(z));
+                    ws.u[2][id] = 0;
+                }
+    });
+
+    ws.fft.forward(ws.u[0].data(), grid.u_hat_x);
+    ws.fft.forward(ws.u[1].data(), grid.u_hat_y);
+    ws.fft.forward(ws.u[2].data(), grid.u_hat_z);
+}
+
+// ------------------------------------------------------------
+// Nonlinear Term: P[u x omega], dealiased by the 2/3 rule
+// ------------------------------------------------------------
+// Rotational form u.grad u = omega x u + grad(|u|^2 / 2); the gradient
+// is absorbed by the pressure, which the Leray projection removes.
+// If diag is given, its maxSpeed and maxVorticity are filled in from the
+// physical fields on the way through. Products are formed in Accum.
+template <class P>
+void computeNonlinear(const SpectralGrid<P>& grid, SolverWorkspace<P>& ws,
+                      const SpectralField<typename P::Store>* const u_hat[3],
+                      SpectralField<typename P::Store>* const n_hat[3],
+                      FlowDiagnostics* diag = nullptr) {
+    using Store = typename P::Store;
+    using Accum = typename P::Accum;
+    const Accum k0 = Accum(2 * PI / grid.L);
 
-                Real x = 2 * PI * i / grid.N;
-                Real y = 2 * PI * j / grid.N;
-                Real z = 2 * PI * k / grid.N;
+    for (int c = 0; c < 3; ++c)
+        ws.fft.inverse(*u_hat[c], ws.u[c].data());
 
-                int id = grid.idx(i,j,k);
+    // omega_hat = i k x u_hat, one component at a time
+    for (int c = 0; c < 3; ++c) {
+        int a = (c + 1) % 3, b = (c + 2) % 3;
+        const Store *are = u_hat[a]->re.data(), *aim = u_hat[a]->im.data();
+        const Store *bre = u_hat[b]->re.data(), *bim = u_hat[b]->im.data();
+        Store *ore = ws.spec.re.data(), *oim = ws.spec.im.data();
 
-                grid.u_hat_x[id] = Complex(std::sin(x) * std::cos(y) * std::cos(z), 0);
-                grid.u_hat_y[id] = Complex(-std::cos(x) * std::sin(y) * std::cos(z), 0);
-                grid.u_hat_z[id] = Complex(0.0, 0.0);
+        parallelSlabs(grid.threads, grid.N, [&](int, int begin, int end) {
+            for (int i = begin; i < end; ++i)
+                for (int j = grid.ky.begin; j < grid.ky.end(); ++j) {
+                    const std::size_t row = grid.idx(i,j,grid.kz.begin);
+                    const Accum kxy[2] = { Accum(grid.wavenumber(i)), Accum(grid.wavenumber(j)) };
+                    // kz varies along the row; kx, ky are fixed
+                    const Accum ka = (a < 2) ? kxy[a] : 0, kb = (b < 2) ? kxy[b] : 0;
+                    const Accum sa = (a == 2) ? k0 : 0, sb = (b == 2) ? k0 : 0;
+                    for (int l = 0; l < grid.kz.count; ++l) {
+                        const int k = grid.kz.begin + l;
+                        Accum kva = ka + sa * k, kvb = kb + sb * k;
+                        ore[row + l] = Store(-(kva * bim[row + l] - kvb * aim[row + l]));
+                        oim[row + l] = Store(kva * bre[row + l] - kvb * are[row + l]);
+                    }
+                }
+        });
+        ws.fft.inverse(ws.spec, ws.w[c].data());
+    }
+
+    const std::size_t plane = std::size_t(grid.py.count) * grid.N;
+    std::vector<Accum> speed(grid.threads, 0), vorticity(grid.threads, 0);
+    parallelSlabs(grid.threads, grid.px.count, [&](int t, int begin, int end) {
+        Store *ux = ws.u[0].data(), *uy = ws.u[1].data(), *uz = ws.u[2].data();
+        Store *wx = ws.w[0].data(), *wy = ws.w[1].data(), *wz = ws.w[2].data();
+        Accum s = 0, v = 0;
+        for (std::size_t id = begin * plane; id < end * plane; ++id) {
+            Accum x = wx[id], y = wy[id], z = wz[id];
+            Accum ax = ux[id], ay = uy[id], az = uz[id];
+            s = std::max(s, std::abs(ax) + std::abs(ay) + std::abs(az));
+            v = std::max(v, x * x + y * y + z * z);
+            wx[id] = Store(ay * z - az * y);
+            wy[id] = Store(az * x - ax * z);
+            wz[id] = Store(ax * y - ay * x);
+        }
+        speed[t] = s;
+        vorticity[t] = v;
+    });
+    if (diag) {
+        diag->maxSpeed = World::max(*std::max_element(speed.begin(), speed.end()));
+        diag->maxVorticity = std::sqrt(World::max(*std::max_element(vorticity.begin(), vorticity.end())));
+    }
+
+    for (int c = 0; c < 3; ++c)
+        ws.fft.forward(ws.w[c].data(), *n_hat[c]);
+
+    // Dealias and project: n <- n - k (k . n) / |k|^2
+    parallelSlabs(grid.threads, grid.N, [&](int, int begin, int end) {
+        Store* nre[3] = { n_hat[0]->re.data(), n_hat[1]->re.data(), n_hat[2]->re.data() };
+        Store* nim[3] = { n_hat[0]->im.data(), n_hat[1]->im.data(), n_hat[2]->im.data() };
+        const int kmax = grid.N / 3;
+        for (int i = begin; i < end; ++i)
+            for (int j = grid.ky.begin; j < grid.ky.end(); ++j) {
+                const std::size_t row = grid.idx(i,j,grid.kz.begin);
+                const Accum kx = Accum(grid.wavenumber(i)), ky = Accum(grid.wavenumber(j));
+                const bool rowResolved = grid.resolved(i, j, 0);
+                for (int l = 0; l < grid.kz.count; ++l) {
+                    const int k = grid.kz.begin + l;
+                    Accum kz = k0 * k;
+                    Accum k2 = kx*kx + ky*ky + kz*kz;
+                    bool keep = rowResolved && k <= kmax && k2 > 0;
+                    Accum inv = keep ? Accum(1) / k2 : Accum(0);
+                    Accum mask = keep ? Accum(1) : Accum(0);
+                    std::size_t id = row + l;
+                    Accum r0 = nre[0][id], r1 = nre[1][id], r2 = nre[2][id];
+                    Accum i0 = nim[0][id], i1 = nim[1][id], i2 = nim[2][id];
+                    Accum dr = (kx * r0 + ky * r1 + kz * r2) * inv;
+                    Accum di = (kx * i0 + ky * i1 + kz * i2) * inv;
+                    nre[0][id] = Store(mask * (r0 - kx * dr));
+                    nre[1][id] = Store(mask * (r1 - ky * dr));
+                    nre[2][id] = Store(mask * (r2 - kz * dr));
+                    nim[0][id] = Store(mask * (i0 - kx * di));
+                    nim[1][id] = Store(mask * (i1 - ky * di));
+                    nim[2][id] = Store(mask * (i2 - kz * di));
+                }
             }
+    });
 }
 
 // ------------------------------------------------------------
-// Semi-Implicit Time Integration (Spectral Space)
+// ETDRK4 Time Integration (Spectral Space)
 // ------------------------------------------------------------
-void advanceTimeStep(SpectralGrid& grid, Real dt) {
-    for (int i = 0; i < grid.N; ++i)
-        for (int j = 0; j < grid.N; ++j)
-            for (int k = 0; k < grid.N; ++k) {
+// Cox–Matthews exponential RK4: viscosity exactly, nonlinearity to fourth
+// order. The step is min(dtMax, cfl * dx / max|u|), with |u| measured on the
+// first stage; the coefficient tables are only rebuilt when it changes by
+// more than the hysteresis band, so most steps reuse them. cfl <= 0 keeps
+// dt = dtMax. Returns the step taken.
+//
+// Each update is one fused pass over the six real channels (re/im of three
+// components). The first pass also accumulates energy, enstrophy and E(k)
+// of the incoming state in thread-local sums, so diag describes u(t)
+// without a separate sweep.
+template <class P>
+Real advanceTimeStep(SpectralGrid<P>& grid, SolverWorkspace<P>& ws, Real dtMax, Real cfl,
+                     FlowDiagnostics& diag) {
+    using Store = typename P::Store;
+    using Accum = typename P::Accum;
+
+    SpectralField<Store>* const u[3] = { &grid.u_hat_x, &grid.u_hat_y, &grid.u_hat_z };
+    SpectralField<Store>* const nv[3] = { &ws.rhs[0], &ws.rhs[1], &ws.rhs[2] };
+    SpectralField<Store>* const s[3] = { &ws.stage[0], &ws.stage[1], &ws.stage[2] };
 
-                int id = grid.idx(i,j,k);
+    computeNonlinear(grid, ws, u, nv, &diag);
 
-                Real kx = (i <= grid.N/2) ? i : i - grid.N;
-                Real ky = (j <= grid.N/2) ? j : j - grid.N;
-                Real kz = (k <= grid.N/2) ? k : k - grid.N;
+    Real dt = dtMax;
+    if (cfl > 0 && diag.maxSpeed > 0) {
+        Real limit = std::min(dtMax, cfl * (grid.L / grid.N) / diag.maxSpeed);
+        dt = ws.etd.dt;
+        if (dt <= 0 || dt > limit || dt < Real(0.5) * limit)
+            dt = (limit == dtMax) ? dtMax : Real(0.8) * limit;
+    }
+    ws.etd.prepare(grid, dt);
+    const ETDCoefficients<Accum>& k = ws.etd;
 
-                Real k2 = kx*kx + ky*ky + kz*kz;
-                Real decay = std::exp(-grid.viscosity * k2 * dt);
+    // Real channel pointers: re and im obey the same real recurrence
+    auto channels = [](auto* const f[3], auto* out[6]) {
+        for (int c = 0; c < 3; ++c) {
+            out[2*c] = f[c]->re.data();
+            out[2*c + 1] = f[c]->im.data();
+        }
+    };
+    SpectralField<Accum>* const acc[3] = { &ws.acc[0], &ws.acc[1], &ws.acc[2] };
+    Store *U[6], *NV[6], *S[6];
+    Accum *A[6];
+    channels(u, U);
+    channels(nv, NV);
+    channels(s, S);
+    channels(acc, A);
 
-                grid.u_hat_x[id] *= decay;
-                grid.u_hat_y[id] *= decay;
-                grid.u_hat_z[id] *= decay;
+    // row(thread, offset of the first local kz, kx^2 + ky^2) for every
+    // (x, y) row; along a row, local l is global kz = kz0 + l
+    const int kz0 = grid.kz.begin, nz = grid.kz.count;
+    auto sweep = [&](auto&& row) {
+        parallelSlabs(grid.threads, grid.N, [&](int t, int begin, int end) {
+            for (int i = begin; i < end; ++i)
+                for (int j = grid.ky.begin; j < grid.ky.end(); ++j) {
+                    int kx = grid.mode(i), ky = grid.mode(j);
+                    row(t, grid.idx(i,j,kz0), kx*kx + ky*ky);
+                }
+        });
+    };
+
+    // a = E2 u + Q N(u); acc = E u + f1 N(u); nv <- E2 a - Q N(u)
+    const int bins = static_cast<int>(ws.shellBin.size() ? ws.shellBin.back() + 1 : 1);
+    std::vector<std::vector<Accum>> partial(grid.threads, std::vector<Accum>(bins + 1, 0));
+    const Real k0sq = (2 * PI / grid.L) * (2 * PI / grid.L);
+    sweep([&](int t, std::size_t row, int kxy) {
+        Accum* bin = partial[t].data();
+        Accum enstrophy = 0;
+        for (int l = 0; l < nz; ++l) {
+            const int kz = kz0 + l;
+            std::size_t id = row + l;
+            int m = kxy + kz * kz;
+            Accum e = 0;
+            for (int c = 0; c < 6; ++c) e += Accum(U[c][id]) * Accum(U[c][id]);
+            e *= Accum(0.5) * ws.weight[kz];
+            bin[ws.shellBin[m]] += e;
+            enstrophy += m * e;
+        }
+        bin[bins] += enstrophy;
+
+        for (int c = 0; c < 6; ++c) {
+            Store *uc = U[c] + row, *nc = NV[c] + row, *sc = S[c] + row;
+            Accum* ac = A[c] + row;
+            for (int l = 0; l < nz; ++l) {
+                int m = kxy + (kz0 + l) * (kz0 + l);
+                Accum uu = uc[l], nn = nc[l];
+                Accum a = k.E2[m] * uu + k.Q[m] * nn;
+                ac[l] = k.E[m] * uu + k.f1[m] * nn;
+                nc[l] = Store(k.E2[m] * a - k.Q[m] * nn);
+                sc[l] = Store(a);
+            }
+        }
+    });
+
+    // Thread partials, then rank partials: E(k) with the enstrophy behind it
+    std::vector<Real> total(bins + 1, 0.0);
+    for (const auto& p : partial) {
+        for (int b = 0; b < bins; ++b) total[b] += p[b];
+        total[bins] += k0sq * p[bins];
+    }
+    World::sum(total.data(), bins + 1);
+    diag.enstrophy = total[bins];
+    diag.spectrum.assign(total.begin(), total.end() - 1);
+    diag.energy = 0.0;
+    for (Real e : diag.spectrum) diag.energy += e;
+
+    // b = E2 u + Q N(a)
+    computeNonlinear(grid, ws, s, s);
+    sweep([&](int, std::size_t row, int kxy) {
+        for (int c = 0; c < 6; ++c) {
+            Store *uc = U[c] + row, *sc = S[c] + row;
+            Accum* ac = A[c] + row;
+            for (int l = 0; l < nz; ++l) {
+                int m = kxy + (kz0 + l) * (kz0 + l);
+                Accum na = sc[l];
+                ac[l] += 2 * k.f2[m] * na;
+                sc[l] = Store(k.E2[m] * uc[l] + k.Q[m] * na);
             }
+        }
+    });
+
+    // c = E2 a + Q (2 N(b) - N(u))
+    computeNonlinear(grid, ws, s, s);
+    sweep([&](int, std::size_t row, int kxy) {
+        for (int c = 0; c < 6; ++c) {
+            Store *nc = NV[c] + row, *sc = S[c] + row;
+            Accum* ac = A[c] + row;
+            for (int l = 0; l < nz; ++l) {
+                int m = kxy + (kz0 + l) * (kz0 + l);
+                Accum nb = sc[l];
+                ac[l] += 2 * k.f2[m] * nb;
+                sc[l] = Store(nc[l] + 2 * k.Q[m] * nb);
+            }
+        }
+    });
+
+    // u <- E u + f1 N(u) + 2 f2 (N(a) + N(b)) + f3 N(c)
+    computeNonlinear(grid, ws, s, s);
+    sweep([&](int, std::size_t row, int kxy) {
+        for (int c = 0; c < 6; ++c) {
+            Store *uc = U[c] + row, *sc = S[c] + row;
+            Accum* ac = A[c] + row;
+            for (int l = 0; l < nz; ++l)
+                uc[l] = Store(ac[l] + k.f3[kxy + (kz0 + l) * (kz0 + l)] * sc[l]);
+        }
+    });
+
+    return dt;
 }
 
 // ------------------------------------------------------------
 // Diagnostic: Enstrophy (Blow-Up Indicator)
 // ------------------------------------------------------------
-Real computeEnstrophy(const SpectralGrid& grid) {
+// Omega = (1/2) <|omega|^2> = (1/2) sum_k |k|^2 |u_hat(k)|^2 (Parseval)
+template <class P>
+Real computeEnstrophy(const SpectralGrid<P>& grid) {
+    using Accum = typename P::Accum;
+    const SpectralField<typename P::Store>* const f[3] = { &grid.u_hat_x, &grid.u_hat_y, &grid.u_hat_z };
+    std::vector<Accum> partial(grid.threads, 0);
+    parallelSlabs(grid.threads, grid.N, [&](int t, int begin, int end) {
+        Accum enstrophy = 0;
+        for (int i = begin; i < end; ++i)
+            for (int j = grid.ky.begin; j < grid.ky.end(); ++j)
+                for (int k = grid.kz.begin; k < grid.kz.end(); ++k) {
+
+                    std::size_t id = grid.idx(i,j,k);
+                    Real kx = grid.wavenumber(i), ky = grid.wavenumber(j), kz = k * (2 * PI / grid.L);
+                    Accum amplitude = 0;
+                    for (int c = 0; c < 3; ++c)
+                        amplitude += Accum(f[c]->re[id]) * f[c]->re[id]
+                                   + Accum(f[c]->im[id]) * f[c]->im[id];
+                    enstrophy += Accum(grid.multiplicity(k) * (kx*kx + ky*ky + kz*kz)) * amplitude;
+                }
+        partial[t] = enstrophy;
+    });
+
     Real enstrophy = 0.0;
-    for (int i = 0; i < grid.N; ++i)
-        for (int j = 0; j < grid.N; ++j)
-            for (int k = 0; k < grid.N; ++k) {
-
-                int id = grid.idx(i,j,k);
-                enstrophy += std::norm(grid.u_hat_x[id])
-                           + std::norm(grid.u_hat_y[id])
-                           + std::norm(grid.u_hat_z[id]);
-            }
-    return enstrophy;
+    for (Accum p : partial) enstrophy += p;
+    World::sum(&enstrophy, 1);
+    return 0.5 * enstrophy;
 }
 
+// ------------------------------------------------------------
+// Checkpoint / Restart (memory-mapped binary snapshots)
+// ------------------------------------------------------------
+// Layout: SnapshotHeader, zero padding to a page boundary, then six
+// arrays of N*N*(N/2+1) values (ux.re, ux.im, uy.re, uy.im, uz.re, uz.im)
+// indexed by (i * N + j) * Nh + k whatever the process grid that wrote it.
+// A post-processing tool can mmap the file and read channel c at
+// offset + c * channelValues * valueBytes without loading the rest. A
+// snapshot restarts bit-identically when its values are at least as wide
+// as the run's storage type; the rank count may differ between runs.
+struct SnapshotHeader {
+    char magic[8];            // "NSSPEC1"
+    std::uint32_t version;
+    std::uint32_t valueBytes; // 8 = double, 4 = float
+    std::int32_t N;
+    std::int32_t Nh;
+    double L;
+    double viscosity;
+    double time;
+    double dt;                // step the ETDRK4 tables were last built for
+    double dtMax;
+    double cfl;
+    double maxEnstrophy;
+    double peakTime;
+    std::int64_t steps;
+    std::uint64_t offset;     // payload start
+    std::uint64_t channelValues;
+    std::int32_t precision;   // Precision of the run (version 2; zero padding reads as Double)
+    std::int32_t storeBytes;  // sizeof its storage type
+};
+
+constexpr char SNAPSHOT_MAGIC[8] = "NSSPEC1";
+constexpr std::uint64_t SNAPSHOT_ALIGN = 4096;
+constexpr std::int32_t SNAPSHOT_MAX_N = 1 << 16;
+
+// Read-only mapping of a snapshot file
+class SnapshotView {
+public:
+    SnapshotView() = default;
+    SnapshotView(const SnapshotView&) = delete;
+    SnapshotView& operator=(const SnapshotView&) = delete;
+    ~SnapshotView() { close(); }
+
+    bool open(const std::string& path, std::string& error) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            error = "cannot open " + path;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(SnapshotHeader))) {
+            ::close(fd);
+            error = path + " is too short to be a snapshot";
+            return false;
+        }
+        bytes = static_cast<std::size_t>(st.st_size);
+        void* p = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            error = "cannot map " + path;
+            return false;
+        }
+        base = static_cast<const unsigned char*>(p);
+
+        // N is bounded before the payload size is formed, and the size
+        // is compared by division, so no header value can wrap the check
+        const SnapshotHeader& h = header();
+        if (std::memcmp(h.magic, SNAPSHOT_MAGIC, sizeof h.magic) != 0
+            || (h.version != 1 && h.version != 2)) {
+            error = path + " is not a spectral snapshot";
+        } else if ((h.valueBytes != 8 && h.valueBytes != 4)
+                   || h.N < 4 || h.N > SNAPSHOT_MAX_N || (h.N & (h.N - 1)) != 0
+                   || h.Nh != h.N / 2 + 1 || h.precision < 0 || h.precision > 2
+                   || h.channelValues != std::uint64_t(h.N) * h.N * h.Nh
+                   || h.offset < sizeof(SnapshotHeader) || h.offset % SNAPSHOT_ALIGN != 0
+                   || h.offset > bytes
+                   || (bytes - h.offset) / (6 * h.valueBytes) < h.channelValues) {
+            error = path + " has an inconsistent header or is truncated";
+        } else {
+            return true;
+        }
+        close();
+        return false;
+    }
+
+    bool isOpen() const { return base != nullptr; }
+
+    void close() {
+        if (base) munmap(const_cast<unsigned char*>(base), bytes);
+        base = nullptr;
+        bytes = 0;
+    }
+
+    const SnapshotHeader& header() const {
+        return *reinterpret_cast<const SnapshotHeader*>(base);
+    }
+
+    // Value v of channel c, whatever the stored precision
+    Real value(int c, std::size_t v) const {
+        const SnapshotHeader& h = header();
+        const unsigned char* p = base + h.offset + (c * h.channelValues + v) * h.valueBytes;
+        if (h.valueBytes == 8) {
+            double d;
+            std::memcpy(&d, p, sizeof d);
+            return d;
+        }
+        float f;
+        std::memcpy(&f, p, sizeof f);
+        return f;
+    }
+
+    // This rank's modes; only the pages holding them are read
+    template <class P>
+    void copyInto(SpectralGrid<P>& grid) const {
+        using Store = typename P::Store;
+        Array<Store>* channels[6] = { &grid.u_hat_x.re, &grid.u_hat_x.im, &grid.u_hat_y.re,
+                                   &grid.u_hat_y.im, &grid.u_hat_z.re, &grid.u_hat_z.im };
+        const SnapshotHeader& h = header();
+        const int nz = grid.kz.count;
+        parallelSlabs(grid.threads, grid.N, [&](int, int begin, int end) {
+            for (int c = 0; c < 6; ++c)
+                for (int i = begin; i < end; ++i)
+                    for (int j = grid.ky.begin; j < grid.ky.end(); ++j) {
+                        Store* dst = channels[c]->data() + grid.idx(i, j, grid.kz.begin);
+                        std::size_t v = (std::size_t(i) * grid.N + j) * grid.Nh + grid.kz.begin;
+                        if (h.valueBytes == sizeof(Store)) {
+                            std::memcpy(dst, base + h.offset + (c * h.channelValues + v) * sizeof(Store),
+                                        nz * sizeof(Store));
+                        } else {
+                            for (int l = 0; l < nz; ++l) dst[l] = Store(value(c, v + l));
+                        }
+                    }
+        });
+    }
+
+private:
+    const unsigned char* base = nullptr;
+    std::size_t bytes = 0;
+};
+
+// Copies this rank's modes on the caller's thread, then writes them
+// through a shared mapping of path.tmp on a background thread and renames
+// it over path, so a crash never leaves a torn snapshot. Rank 0 creates
+// the file and writes the header; with several ranks the rename waits
+// until all of them have synced their rows. Time stepping only waits if
+// the previous snapshot is still being written. write and wait are
+// collective.
+class CheckpointWriter {
+public:
+    ~CheckpointWriter() { wait(); }
+
+    template <class P>
+    void write(const std::string& path, const SpectralGrid<P>& grid, SnapshotHeader header) {
+        using Store = typename P::Store;
+        wait();
+
+        const Array<Store>* channels[6] = { &grid.u_hat_x.re, &grid.u_hat_x.im, &grid.u_hat_y.re,
+                                         &grid.u_hat_y.im, &grid.u_hat_z.re, &grid.u_hat_z.im };
+        const std::size_t values = grid.spectralSize();
+        header.channelValues = std::uint64_t(grid.N) * grid.N * grid.Nh;
+        header.offset = SNAPSHOT_ALIGN;
+        staging.resize(6 * values * header.valueBytes);
+
+        for (int c = 0; c < 6; ++c) {
+            unsigned char* dst = staging.data() + c * values * header.valueBytes;
+            if (header.valueBytes == sizeof(Store)) {
+                std::memcpy(dst, channels[c]->data(), values * sizeof(Store));
+            } else if (header.valueBytes == 8) {
+                for (std::size_t v = 0; v < values; ++v) {
+                    double d = static_cast<double>((*channels[c])[v]);
+                    std::memcpy(dst + v * 8, &d, 8);
+                }
+            } else {
+                for (std::size_t v = 0; v < values; ++v) {
+                    float f = static_cast<float>((*channels[c])[v]);
+                    std::memcpy(dst + v * 4, &f, 4);
+                }
+            }
+        }
+
+        target = path;
+        N = grid.N;
+        ky = grid.ky;
+        kz = grid.kz;
+        ok = !World::root() || create(header);
+        if (!World::all(ok)) {
+            if (ok) error = "rank 0 could not create " + path + ".tmp";
+            ok = false;
+            return;
+        }
+
+        const bool root = World::root(), alone = World::size() == 1;
+        pending = true;
+        worker = std::thread([this, header, root, alone] { ok = persist(header, root, alone); });
+    }
+
+    // Block until the pending snapshot is on disk; false if it failed
+    bool wait() {
+        if (!pending) return ok;
+        worker.join();
+        pending = false;
+        if (World::size() == 1) return ok;
+
+        if (!World::all(ok)) {
+            if (ok) error = "another rank could not write " + target + ".tmp";
+            return ok = false;
+        }
+        if (World::root() && std::rename((target + ".tmp").c_str(), target.c_str()) != 0) {
+            error = "cannot commit " + target;
+            ok = false;
+        }
+        if (!World::all(ok)) {
+            if (ok) error = "rank 0 could not commit " + target;
+            ok = false;
+        }
+        return ok;
+    }
+
+    const std::string& lastError() const { return error; }
+
+private:
+    std::thread worker;
+    bool pending = false;
+    std::vector<unsigned char> staging;
+    std::string target;
+    int N = 0;
+    Range ky, kz;   // rows staged by this rank
+    bool ok = true;
+    std::string error;
+
+    static std::size_t fileSize(const SnapshotHeader& header) {
+        return header.offset + 6 * header.channelValues * header.valueBytes;
+    }
+
+    bool create(const SnapshotHeader& header) {
+        const std::string tmp = target + ".tmp";
+        int fd = ::open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            error = "cannot create " + tmp;
+            return false;
+        }
+        bool sized = ftruncate(fd, static_cast<off_t>(fileSize(header))) == 0;
+        ::close(fd);
+        if (!sized) error = "cannot size " + tmp;
+        return sized;
+    }
+
+    bool persist(const SnapshotHeader& header, bool root, bool alone) {
+        const std::string tmp = target + ".tmp";
+        const std::size_t total = fileSize(header);
+
+        int fd = ::open(tmp.c_str(), O_RDWR);
+        if (fd < 0) {
+            error = "cannot open " + tmp;
+            return false;
+        }
+        void* p = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            error = "cannot map " + tmp;
+            return false;
+        }
+
+        // Each staged row of kz.count values lands at its global index
+        unsigned char* out = static_cast<unsigned char*>(p);
+        const std::size_t bytes = header.valueBytes, Nh = N/2 + 1;
+        const std::size_t values = staging.size() / (6 * bytes);
+        if (root) std::memcpy(out, &header, sizeof header);
+        for (int c = 0; c < 6; ++c)
+            for (int i = 0; i < N; ++i)
+                for (int j = ky.begin; j < ky.end(); ++j) {
+                    std::size_t v = (std::size_t(i) * N + j) * Nh + kz.begin;
+                    std::size_t s = (std::size_t(i) * ky.count + (j - ky.begin)) * kz.count;
+                    std::memcpy(out + header.offset + (c * header.channelValues + v) * bytes,
+                                staging.data() + (c * values + s) * bytes, kz.count * bytes);
+                }
+        bool synced = msync(p, total, MS_SYNC) == 0;
+        munmap(p, total);
+
+        if (!synced || (alone && std::rename(tmp.c_str(), target.c_str()) != 0)) {
+            error = "cannot commit " + target;
+            return false;
+        }
+        return true;
+    }
+};
+
 // ------------------------------------------------------------
 // CLI Simulation Loop
 // ------------------------------------------------------------
-void runSimulation() {
-    int N;
-    Real dt, T, nu;
+struct RunSettings {
+    int N = 0;
+    int threads = 1;
+    Real dt = 0, T = 0, nu = 0, cfl = 0;
+    Precision precision = Precision::Double;
+    std::string checkpoint = "-";
+    long checkpointEvery = 0;
+    int checkpointBits = 64;
+};
 
-    std::cout << "\nGrid resolution N (e.g. 32, 64, 128): ";
-    std::cin >> N;
+// Rank 0's settings on every rank
+void broadcast(RunSettings& run) {
+    World::broadcast(run.N);
+    World::broadcast(run.threads);
+    World::broadcast(run.dt);
+    World::broadcast(run.T);
+    World::broadcast(run.nu);
+    World::broadcast(run.cfl);
+    World::broadcast(run.precision);
+    World::broadcast(run.checkpoint);
+    World::broadcast(run.checkpointEvery);
+    World::broadcast(run.checkpointBits);
+}
 
-    std::cout << "Time step dt: ";
-    std::cin >> dt;
+template <class P>
+void simulate(const RunSettings& run, const ProcessGrid& procs, SnapshotView& snapshot) {
+    const int N = run.N;
+    const Real dt = run.dt, T = run.T, cfl = run.cfl;
 
-    std::cout << "Final simulation time T: ";
-    std::cin >> T;
+    flushDenormals();
+    SpectralGrid<P> grid(N, 2 * PI, run.nu, run.threads, procs);
+    SolverWorkspace<P> ws(grid);
 
-    std::cout << "Viscosity nu: ";
-    std::cin >> nu;
+    Real t = 0.0;
+    Real maxEnstrophy = 0.0, peakTime = 0.0;
+    long steps = 0;
+
+    if (snapshot.isOpen()) {
+        const SnapshotHeader& h = snapshot.header();
+        snapshot.copyInto(grid);
+        t = h.time;
+        steps = h.steps;
+        maxEnstrophy = h.maxEnstrophy;
+        peakTime = h.peakTime;
+        if (h.dt > 0) ws.etd.prepare(grid, h.dt);
+        snapshot.close();
+    } else {
+        initializeTaylorGreenVortex(grid, ws);
+    }
 
-    SpectralGrid grid(N, 2 * PI, nu);
-    initializeTaylorGreenVortex(grid);
+    CheckpointWriter writer;
+    auto saveCheckpoint = [&]() {
+        SnapshotHeader h{};
+        std::memcpy(h.magic, SNAPSHOT_MAGIC, sizeof h.magic);
+        h.version = 2;
+        h.valueBytes = (run.checkpointBits == 32) ? 4 : 8;
+        h.N = grid.N;
+        h.Nh = grid.Nh;
+        h.L = grid.L;
+        h.viscosity = grid.viscosity;
+        h.time = t;
+        h.dt = ws.etd.dt;
+        h.dtMax = dt;
+        h.cfl = cfl;
+        h.maxEnstrophy = maxEnstrophy;
+        h.peakTime = peakTime;
+        h.steps = steps;
+        h.precision = static_cast<std::int32_t>(run.precision);
+        h.storeBytes = sizeof(typename P::Store);
+        if (!writer.wait())
+            console() << "Checkpoint failed: " << writer.lastError() << "\n";
+        writer.write(run.checkpoint, grid, h);
+    };
 
-    int steps = static_cast<int>(T / dt);
-    Real maxEnstrophy = 0.0;
+    const Real t0 = t;
+    Real nextReport = t0;
+    FlowDiagnostics diag, peak;
 
-    for (int step = 0; step < steps; ++step) {
-        advanceTimeStep(grid, dt);
-        Real E = computeEnstrophy(grid);
-        maxEnstrophy = std::max(maxEnstrophy, E);
+    while (T - t > 1e-9 * T) {
+        Real h = advanceTimeStep(grid, ws, std::min(dt, T - t), cfl, diag);
+        if (diag.enstrophy > maxEnstrophy) {
+            maxEnstrophy = diag.enstrophy;
+            peakTime = t;
+            peak = diag;
+        }
 
-        if (step % (steps / 10 + 1) == 0) {
-            std::cout << "t = " << step * dt
-                      << " | Enstrophy = " << std::scientific << E << "\n";
+        if (t >= nextReport - 1e-9 * T) {
+            console() << "t = " << std::scientific << t
+                      << " | dt = " << h
+                      << " | E = " << diag.energy
+                      << " | Enstrophy = " << diag.enstrophy
+                      << " | max|omega| = " << diag.maxVorticity << "\n";
+            nextReport += (T - t0) / 10;
         }
 
-        if (E > 1e12) {
-            std::cout << "\n⚠️ Potential blow-up detected.\n";
+        if (diag.enstrophy > 1e12) {
+            console() << "\n⚠️ Potential blow-up detected.\n";
             break;
         }
+
+        t += h;
+        ++steps;
+
+        if (run.checkpointEvery > 0 && steps % run.checkpointEvery == 0)
+            saveCheckpoint();
+    }
+
+    if (run.checkpoint != "-") {
+        saveCheckpoint();
+        if (writer.wait())
+            console() << "\nSnapshot at t = " << std::scientific << t << " written to "
+                      << run.checkpoint << "\n";
+        else
+            console() << "\nCheckpoint failed: " << writer.lastError() << "\n";
+    }
+
+    console() << "\nMax Enstrophy Observed: "
+              << std::scientific << maxEnstrophy << " at t = " << peakTime
+              << " (" << steps << " steps)\n";
+    const Real finalEnstrophy = computeEnstrophy(grid);
+    console() << "Final Enstrophy: " << finalEnstrophy << "\n";
+
+    if (!peak.spectrum.empty()) {
+        console() << "\nEnergy spectrum E(k) at peak enstrophy:\n";
+        for (int b = 1; b <= N / 3 && b < static_cast<int>(peak.spectrum.size()); ++b)
+            console() << "  k = " << std::setw(4) << b << "   E(k) = " << peak.spectrum[b] << "\n";
+    }
+}
+
+// Prompts on rank 0; false if the run cannot go ahead
+bool readSettings(RunSettings& run, std::string& restart, SnapshotView& snapshot) {
+    std::cout << "\nRestart from snapshot (path, or - for a new run): ";
+    std::cin >> restart;
+
+    if (restart != "-") {
+        std::string error;
+        if (!snapshot.open(restart, error)) {
+            std::cout << "Cannot restart: " << error << "\n";
+            return false;
+        }
+        const SnapshotHeader& h = snapshot.header();
+        run.N = h.N;
+        run.dt = h.dtMax;
+        run.cfl = h.cfl;
+        run.nu = h.viscosity;
+        run.precision = static_cast<Precision>(h.precision);
+        std::uint32_t storeBytes = (h.version >= 2) ? h.storeBytes : 8;
+        std::cout << "Snapshot: N = " << run.N << ", t = " << h.time << ", nu = " << run.nu
+                  << ", " << precisionName(run.precision) << ", "
+                  << 8 * h.valueBytes << "-bit values"
+                  << (h.valueBytes >= storeBytes ? "" : " (restart will not be bit-identical)")
+                  << "\n";
+    } else {
+        std::cout << "Grid resolution N (power of two, e.g. 32, 64, 128): ";
+        std::cin >> run.N;
+        if (run.N < 4 || (run.N & (run.N - 1)) != 0) {
+            std::cout << "N must be a power of two >= 4.\n";
+            return false;
+        }
+
+        std::cout << "Maximum time step dt: ";
+        std::cin >> run.dt;
+
+        std::cout << "CFL number (e.g. 0.5, or 0 for fixed dt): ";
+        std::cin >> run.cfl;
+
+        std::cout << "Viscosity nu: ";
+        std::cin >> run.nu;
+
+        int mode;
+        std::cout << "Precision (0 = double, 1 = float storage / double sums, 2 = float): ";
+        std::cin >> mode;
+        run.precision = (mode == 1) ? Precision::Mixed
+                       : (mode == 2) ? Precision::Single : Precision::Double;
     }
 
-    std::cout << "\nMax Enstrophy Observed: "
-              << std::scientific << maxEnstrophy << "\n";
+    std::cout << "Final simulation time T: ";
+    std::cin >> run.T;
+
+    std::cout << (World::size() > 1 ? "Threads per rank (0 = all cores): " : "Threads (0 = all cores): ");
+    std::cin >> run.threads;
+    if (run.threads <= 0) run.threads = std::max(1u, std::thread::hardware_concurrency());
+    run.threads = std::min(run.threads, run.N);
+
+    std::cout << "Checkpoint file (or - for none): ";
+    std::cin >> run.checkpoint;
+    if (run.checkpoint != "-") {
+        std::cout << "Checkpoint every n steps: ";
+        std::cin >> run.checkpointEvery;
+        std::cout << "Checkpoint precision in bits (64 or 32): ";
+        std::cin >> run.checkpointBits;
+    }
+    return true;
+}
+
+void runSimulation() {
+    RunSettings run;
+    std::string restart;
+    SnapshotView snapshot;
+
+    bool ok = !World::root() || readSettings(run, restart, snapshot);
+    if (!World::all(ok)) return;
+    broadcast(run);
+    World::broadcast(restart);
+
+    // Every rank maps the snapshot and reads only its own modes
+    std::string error;
+    if (restart != "-" && !snapshot.isOpen()) ok = snapshot.open(restart, error);
+    if (!World::all(ok)) {
+        console() << "Cannot restart: " << restart << " is unreadable on some ranks\n";
+        return;
+    }
+
+    ProcessGrid procs;
+    if (!procs.fits(run.N)) {
+        console() << World::size() << " ranks (" << procs.rows << " x " << procs.cols
+                  << ") are too many for N = " << run.N << ".\n";
+        return;
+    }
+    if (World::size() > 1)
+        console() << "Pencil grid: " << procs.rows << " x " << procs.cols << " ranks, "
+                  << run.threads << " thread(s) each\n";
+
+    switch (run.precision) {
+        case Precision::Mixed:  simulate<MixedPrecision>(run, procs, snapshot); break;
+        case Precision::Single: simulate<SinglePrecision>(run, procs, snapshot); break;
+        default:                simulate<DoublePrecision>(run, procs, snapshot); break;
+    }
 }
 
 // ------------------------------------------------------------
 // MAIN PROGRAM (Repeatable Scientific Workflow)
 // ------------------------------------------------------------
 int main() {
-    std::cout << "=============================================\n";
-    std::cout << "  3D Navier–Stokes Finite-Time Blow-Up Explorer\n";
-    std::cout << "=============================================\n";
+#ifdef NS_USE_MPI
+    // Only the main thread of each rank calls MPI
+    int provided;
+    MPI_Init_thread(nullptr, nullptr, MPI_THREAD_FUNNELED, &provided);
+#endif
+
+    console() << "=============================================\n";
+    console() << "  3D Navier–Stokes Finite-Time Blow-Up Explorer\n";
+    console() << "=============================================\n";
 
-    char choice;
+    char choice = 'n';
     do {
         runSimulation();
-        std::cout << "\nRun another simulation? (y/n): ";
-        std::cin >> choice;
+        console() << "\nRun another simulation? (y/n): ";
+        if (World::root()) std::cin >> choice;
+        World::broadcast(choice);
     } while (choice == 'y' || choice == 'Y');
 
-    std::cout << "\nProgram terminated. Stay curious.\n";
+    console() << "\nProgram terminated. Stay curious.\n";
+#ifdef NS_USE_MPI
+    MPI_Finalize();
+#endif
     return 0;
 }
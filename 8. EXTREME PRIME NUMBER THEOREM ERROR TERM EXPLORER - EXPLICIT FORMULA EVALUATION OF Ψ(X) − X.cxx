@@ -4,6 +4,21 @@
 #include <cmath>
 #include <iomanip>
 #include <limits>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 
@@ -24,16 +39,43 @@ using cplx = complex<ld>;
 // ---------------------------------------------------------
 // Non-trivial Riemann zeta zero container
 // rho = 1/2 + i*gamma
+// gamma is kept as an unevaluated sum hi + lo: at heights
+// near 1e8 the nine decimals of published tables need more
+// digits than a double holds.
 // ---------------------------------------------------------
 struct ZetaZero {
-    ld gamma;
+    double hi;
+    double lo;
+
+    ld gamma() const { return ld(hi) + ld(lo); }
+};
+
+// ---------------------------------------------------------
+// Non-owning view of consecutive zeros, sorted by height
+// ---------------------------------------------------------
+struct ZeroSpan {
+    const ZetaZero* first = nullptr;
+    size_t count = 0;
+
+    const ZetaZero* begin() const { return first; }
+    const ZetaZero* end() const { return first + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // Zeros with gamma <= T; binary search, so only a few
+    // pages of a mapped table are touched
+    ZeroSpan up_to(ld T) const {
+        const ZetaZero* last = upper_bound(begin(), end(), T,
+            [](ld t, const ZetaZero& z) { return t < z.gamma(); });
+        return { first, size_t(last - first) };
+    }
 };
 
 // ---------------------------------------------------------
 // Compute x^rho / rho using complex arithmetic
 // ---------------------------------------------------------
 cplx x_to_rho_over_rho(ld x, const ZetaZero& zero) {
-    cplx rho(0.5L, zero.gamma);
+    cplx rho(0.5L, zero.gamma());
     cplx logx = log(x);
     cplx exponent = rho * logx;
     cplx x_rho = exp(exponent);
@@ -41,39 +83,1234 @@ cplx x_to_rho_over_rho(ld x, const ZetaZero& zero) {
 }
 
 // ---------------------------------------------------------
-// Explicit formula for ψ(x)
+// Fast zero sum
+// Summed in pairs, x^rho / rho + conj = 2 sqrt(x) Re(e^{i theta} / rho)
+// with theta = gamma log x, so per zero only
+//     (cos theta / 2 + gamma sin theta) / (1/4 + gamma^2)
+// is needed. log x is formed once; theta, which reaches 1e10
+// radians, is the double-double product of gamma (hi + lo)
+// and log x, reduced by pi/2 in three parts with exact FMA
+// products. sin and cos of the remainder are polynomials on
+// [-pi/4, pi/4] with the quadrant applied by selects, so the
+// lane loop has no branches or library calls and compiles to
+// vector code (-O3 -march=native for FMA and wide vectors).
+// Each lane keeps its own Kahan-compensated sum.
 // ---------------------------------------------------------
-ld psi_explicit(ld x, const vector<ZetaZero>& zeros) {
-    cplx sum = 0.0L;
+struct DoubleDouble {
+    double hi;
+    double lo;
+};
 
-    for (const auto& z : zeros) {
-        cplx term = x_to_rho_over_rho(x, z);
-        sum += term;
-        sum += conj(term); // conjugate pair
+// 64-bit long double mantissa split exactly into two doubles
+DoubleDouble split(ld v) {
+    double hi = double(v);
+    return { hi, double(v - ld(hi)) };
+}
+
+// a + b as an unevaluated double-double (Knuth's two-sum)
+inline DoubleDouble two_sum(double a, double b) {
+    double s = a + b;
+    double b_virtual = s - a;
+    return { s, (a - (s - b_virtual)) + (b - b_virtual) };
+}
+
+constexpr int ZERO_SUM_LANES = 8;
+
+// sin and cos of theta = a * b, for phases far beyond 2 pi
+inline void sin_cos_product(DoubleDouble a, DoubleDouble b, double& sin_theta, double& cos_theta) {
+    constexpr double TWO_OVER_PI = 0.6366197723675814;
+    constexpr double PIO2_1 = 1.5707963267948966;
+    constexpr double PIO2_2 = 6.123233995736766e-17;
+    constexpr double PIO2_3 = -1.4973849048591698e-33;
+    constexpr double ROUND = 6755399441055744.0;           // 1.5 * 2^52
+
+    // theta = a * b in double-double
+    double theta = a.hi * b.hi;
+    double theta_lo = fma(a.hi, b.hi, -theta) + (a.hi * b.lo + a.lo * b.hi);
+
+    // r = theta - n pi/2; n * PIO2_1 cancels exactly inside the fma.
+    // n's low bits are left at the bottom of the rounded mantissa.
+    double rounded = theta * TWO_OVER_PI + ROUND;
+    uint64_t bits;
+    memcpy(&bits, &rounded, sizeof bits);
+    double n = rounded - ROUND;
+    double t = fma(-n, PIO2_1, theta);
+    double p = n * PIO2_2;
+    double p_lo = fma(n, PIO2_2, -p);
+    double r_hi = t - p;
+    double r_tail = ((t - r_hi) - p) + (theta_lo - p_lo - n * PIO2_3);
+    // theta_lo is up to ulp(theta), 4e-6 at theta = 3e10; fold it into
+    // r so the first-order correction below only sees rounding
+    double r = r_hi + r_tail;
+    double r_lo = r_tail - (r - r_hi);
+    double z = r * r;
+
+    double s = r + r * z * (-1.66666666666666324348e-01 + z * (8.33333333332248946124e-03
+             + z * (-1.98412698298579493134e-04 + z * (2.75573137070700676789e-06
+             + z * (-2.50507602534068634195e-08 + z * 1.58969099521155010221e-10)))));
+    double c = 1.0 - 0.5 * z + z * z * (4.16666666666666019037e-02 + z * (-1.38888888888741095749e-03
+             + z * (2.48015872894767294178e-05 + z * (-2.75573143513906633035e-07
+             + z * (2.08757232129817482790e-09 + z * -1.13596475577881948265e-11)))));
+    double sin_r = s + c * r_lo;
+    double cos_r = c - s * r_lo;
+
+    // Quadrant n mod 4: (cos, sin) -> (c, s), (-s, c), (-c, -s), (s, -c)
+    const uint64_t q = bits & 3;
+    sin_theta = (q & 1) ? cos_r : sin_r;
+    cos_theta = (q & 1) ? sin_r : cos_r;
+    sin_theta = (q & 2) ? -sin_theta : sin_theta;
+    cos_theta = ((q + 1) & 2) ? -cos_theta : cos_theta;
+}
+
+// (cos theta / 2 + gamma sin theta) / (1/4 + gamma^2), theta = gamma * log_x
+inline double zero_term(double gamma_hi, double gamma_lo, DoubleDouble log_x) {
+    double sin_theta, cos_theta;
+    sin_cos_product({ gamma_hi, gamma_lo }, log_x, sin_theta, cos_theta);
+    return (0.5 * cos_theta + gamma_hi * sin_theta) / (0.25 + gamma_hi * gamma_hi);
+}
+
+// sum over zeros of (x^rho / rho + conj), what psi_explicit subtracts
+ld zero_sum_fast(ld x, ZeroSpan zeros) {
+    const DoubleDouble log_x = split(logl(x));
+    const ZetaZero* z = zeros.begin();
+    const size_t count = zeros.size();
+
+    double sum[ZERO_SUM_LANES] = {}, compensation[ZERO_SUM_LANES] = {};
+    size_t k = 0;
+    for (; k + ZERO_SUM_LANES <= count; k += ZERO_SUM_LANES) {
+        double term[ZERO_SUM_LANES];
+        for (int l = 0; l < ZERO_SUM_LANES; ++l)
+            term[l] = zero_term(z[k + l].hi, z[k + l].lo, log_x);
+        for (int l = 0; l < ZERO_SUM_LANES; ++l) {
+            double y = term[l] - compensation[l];
+            double t = sum[l] + y;
+            compensation[l] = (t - sum[l]) - y;
+            sum[l] = t;
+        }
     }
 
+    ld total = 0.0L;
+    for (; k < count; ++k) total += zero_term(z[k].hi, z[k].lo, log_x);
+    for (int l = 0; l < ZERO_SUM_LANES; ++l) total += ld(sum[l]) - ld(compensation[l]);
+    return 2.0L * sqrtl(x) * total;
+}
+
+// ---------------------------------------------------------
+// Explicit formula for ψ(x)
+// ---------------------------------------------------------
+ld psi_explicit(ld x, ZeroSpan zeros) {
+    ld sum = zero_sum_fast(x, zeros);   // conjugate pairs included
+
     ld correction1 = log(2.0L * M_PIl);
     ld correction2 = 0.5L * log(1.0L - pow(x, -2.0L));
 
-    ld psi = x - real(sum) - correction1 - correction2;
+    ld psi = x - sum - correction1 - correction2;
+    return psi;
+}
+
+// ---------------------------------------------------------
+// Batch evaluation over many x: type-3 NUFFT
+// With u = log x the zero sum is
+//     S(x) = sum_k x^rho_k / rho_k = sqrt(x) sum_k a_k e^{i gamma_k u},
+// a_k = 1 / rho_k: nonuniform frequencies gamma_k at nonuniform
+// points u_j. Following Lee and Greengard, both sets are
+// centred (u = u_c + s, gamma = gamma_c + g with |s| <= S,
+// |g| <= G), the a_k are spread onto a uniform g-grid with a
+// Gaussian of variance 2 tau1, whose transform over g is a
+// type-2 sum evaluated at the s_j by Gaussian gridding and one
+// FFT; dividing by the Gaussian's transform e^{-tau1 s^2}
+// recovers S. Cost is O(K Msp + M Msp + L log L) for K zeros
+// and M points, L ~ 4 G S / pi, instead of O(K M).
+//
+// Every stage is sized from eps so that the error of each
+// S(x_j) stays below eps * sqrt(x_j) * sum |a_k|. The centres
+// u_c and gamma_c are doubles, so the phases g_k u_c and
+// gamma_c u_j, which reach 1e10 radians, are double-double
+// products reduced as in zero_term, and so are the offsets
+// of g_k and of dg s_j from their grids: an offset rounded to
+// double would be multiplied by up to L and cost 1e-16 G S.
+// The grid values are double, and the FFT's rounding, scaled
+// up by the deconvolutions, leaves a floor that grows with
+// the grid (measured against __float128 sums: about 8e-14 at
+// L = 2^25). Requests below NUFFT_ROUNDOFF * L / 2 are raised
+// to it, and the eps actually used is returned in the stats.
+// ---------------------------------------------------------
+using cd = complex<double>;
+
+// In-place radix-2 FFT, sign +1 computes sum_n a_n e^{+2 pi i nm/N}
+void fft_inplace(vector<cd>& a, int sign) {
+    const size_t n = a.size();
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) swap(a[i], a[j]);
+    }
+    for (size_t len = 2; len <= n; len <<= 1) {
+        const double angle = sign * 2.0 * M_PI / double(len);
+        vector<cd> w(len / 2);
+        for (size_t m = 0; m < len / 2; ++m)
+            w[m] = polar(1.0, angle * double(m));
+        for (size_t s = 0; s < n; s += len)
+            for (size_t m = 0; m < len / 2; ++m) {
+                cd t = w[m] * a[s + m + len / 2];
+                a[s + m + len / 2] = a[s + m] - t;
+                a[s + m] += t;
+            }
+    }
+}
+
+struct NufftStats {
+    double eps = 0.0;         // accuracy used, at least the rounding floor
+    size_t grid = 0;          // FFT length (largest over the bands)
+    size_t bands = 0;         // height bands the zeros were split into
+    int spread_g = 0;         // Gaussian half-widths in grid points
+    int spread_s = 0;
+    double weight = 0.0;      // sum |a_k|, the scale of the error bound
+};
+
+// Fewer than 2^25 g-grid points per band, an FFT of 2^26 (1 GiB)
+constexpr int64_t NUFFT_MAX_HALF = int64_t(1) << 24;
+
+// Achievable eps per g-grid point, and below any grid
+constexpr double NUFFT_ROUNDOFF = 1e-20;
+constexpr double NUFFT_MIN_EPS = 1e-15;
+
+constexpr double TWO_PI_LO = 2.4492935982947064e-16;    // 2 pi - double(2 pi)
+
+// v - n * step, exact until the final rounding: n * step.hi
+// is split by an fma, so large n keeps the offset's digits
+inline double offset_from_grid(DoubleDouble v, long n, DoubleDouble step) {
+    const double p = double(n) * step.hi;
+    const double p_err = fma(double(n), step.hi, -p);
+    return ((v.hi - p) - p_err) + (v.lo - double(n) * step.lo);
+}
+
+// Spacing and Gaussian of the g-grid for an s-range of half-width S
+struct NufftGrid {
+    double E;                 // log of the inverse stage error
+    double dg;
+    double tau1;
+    int w1;
+
+    NufftGrid(double S, double eps) {
+        // Stage errors are amplified by at most e^{tau1 S^2} = e^{E/8}
+        // when the Gaussian is divided out; E leaves eps after that.
+        E = (8.0 / 7.0) * log(1.0 / eps) + 1.0;
+        dg = M_PI / (2.0 * S);                       // s-period 4S: twofold oversampling
+        tau1 = E / (8.0 * S * S);                    // aliases below e^{-E} at |s| <= S
+        w1 = int(ceil(sqrt(4.0 * tau1 * E) / dg));   // tails below e^{-E}
+    }
+};
+
+// Adds sum_k a_k e^{i gamma_k u_j} over one band of zeros to result
+void zero_sum_nufft_band(const vector<ld>& xs, const vector<ld>& u, double u_c, double S,
+                         ZeroSpan zeros, double eps, vector<cplx>& result, NufftStats* stats) {
+    const size_t M = xs.size();
+    const double g_c = double(0.5L * (zeros.begin()->gamma() + (zeros.end() - 1)->gamma()));
+    const double G = max(double((zeros.end() - 1)->gamma() - g_c), 1.0);
+
+    const NufftGrid grid(S, eps);
+    const double E = grid.E, dg = grid.dg, tau1 = grid.tau1;
+    const int w1 = grid.w1;
+    const int64_t half = int64_t(ceil(G / dg)) + w1;
+    const size_t L = size_t(2 * half + 1);
+
+    // Spread a_k e^{i g_k u_c} onto g_l = l dg, |l| <= half, with
+    // e^{-(g_l - g_k)^2 / 4 tau1}, factored so each zero costs
+    // two exponentials (fast Gaussian gridding)
+    vector<cd> grid_g(L, cd(0.0));
+    vector<double> tail(w1 + 1);
+    for (int m = 0; m <= w1; ++m) tail[m] = exp(-(m * dg) * (m * dg) / (4.0 * tau1));
+    for (const auto& z : zeros) {
+        DoubleDouble g = two_sum(z.hi, -g_c);
+        g.lo += z.lo;
+        double sin_phase, cos_phase;
+        sin_cos_product(g, { u_c, 0.0 }, sin_phase, cos_phase);
+        const cplx a = cplx(cos_phase, sin_phase) / cplx(0.5L, z.gamma());
+        const long l0 = lround(g.hi / dg);
+        const double d = offset_from_grid(g, l0, { dg, 0.0 });   // |d| <= dg / 2
+        const double e1 = exp(-d * d / (4.0 * tau1));
+        const double e2 = exp(d * dg / (2.0 * tau1));
+        const cd base(double(a.real()) * e1, double(a.imag()) * e1);
+        // (g_{l0+m} - g)^2 = (m dg)^2 - 2 m dg d + d^2
+        double up = 1.0, down = 1.0;
+        grid_g[l0 + half] += base;
+        for (int m = 1; m <= w1; ++m) {
+            up *= e2;
+            down /= e2;
+            grid_g[l0 + half + m] += base * (tail[m] * up);
+            grid_g[l0 + half - m] += base * (tail[m] * down);
+        }
+    }
+
+    // Type 2: f(theta) = sum_l c_l e^{i l theta} at theta_j = dg s_j,
+    // |theta_j| <= pi/2, by deconvolution, FFT and Gaussian gridding
+    const double eps2 = eps * exp(-E / 8.0);
+    size_t Mr = 1;
+    while (Mr < 2 * L) Mr <<= 1;
+    const double R = double(Mr) / double(L);
+    const int w2 = int(ceil(log(1.0 / eps2) * R / (M_PI * (R - 0.5))));
+    const double tau2 = M_PI * w2 / (double(L) * double(L) * R * (R - 0.5));
+
+    vector<cd> fine(Mr, cd(0.0));
+    for (int64_t l = -half; l <= half; ++l) {
+        // divide by the Fourier coefficient sqrt(tau2/pi) e^{-l^2 tau2}
+        double inv = sqrt(M_PI / tau2) * exp(double(l) * double(l) * tau2);
+        fine[(l + int64_t(Mr)) % int64_t(Mr)] = grid_g[l + half] * inv;
+    }
+    fft_inplace(fine, +1);
+
+    // theta_j and its offset from the fine grid are double-double
+    // until the last subtraction: l theta_j reaches G S radians
+    const double h = 2.0 * M_PI / double(Mr);
+    const DoubleDouble h_dd = { h, TWO_PI_LO / double(Mr) };
+    for (size_t j = 0; j < M; ++j) {
+        const DoubleDouble s_dd = split(u[j] - ld(u_c));
+        const double s = s_dd.hi;
+        DoubleDouble theta = { dg * s_dd.hi, 0.0 };
+        theta.lo = fma(dg, s_dd.hi, -theta.hi) + dg * s_dd.lo;
+        const long m0 = lround(theta.hi / h);
+        const double d = offset_from_grid(theta, m0, h_dd);
+        cd f(0.0);
+        for (int m = -w2; m <= w2; ++m) {
+            double off = d - m * h;
+            f += fine[((m0 + m) % long(Mr) + long(Mr)) % long(Mr)] * exp(-off * off / (4.0 * tau2));
+        }
+        f /= double(Mr);
+
+        // H(s) = dg f;  F(s) = e^{tau1 s^2} H(s) / sqrt(4 pi tau1)
+        const cd F = f * (dg * exp(tau1 * s * s) / sqrt(4.0 * M_PI * tau1));
+        double sin_phase, cos_phase;
+        sin_cos_product({ g_c, 0.0 }, split(u[j]), sin_phase, cos_phase);
+        result[j] += sqrt(xs[j]) * cplx(cos_phase, sin_phase) * cplx(F.real(), F.imag());
+    }
+
+    if (stats) {
+        stats->grid = max(stats->grid, Mr);
+        stats->spread_g = w1;
+        stats->spread_s = max(stats->spread_s, w2);
+    }
+}
+
+// sum_k x_j^rho_k / rho_k for every x_j (the conjugate zeros are
+// left to the caller, as in psi_explicit). Zeros are taken in
+// height bands narrow enough that each band's grid stays within
+// NUFFT_MAX_HALF; S(x) is linear in the zeros, so the bands'
+// sums and error bounds simply add.
+vector<cplx> zero_sum_nufft(const vector<ld>& xs, ZeroSpan zeros, double eps,
+                            NufftStats* stats = nullptr) {
+    const size_t M = xs.size(), K = zeros.size();
+    vector<cplx> result(M, cplx(0.0L));
+    if (stats) {
+        *stats = NufftStats();
+        stats->eps = eps;
+    }
+    if (M == 0 || K == 0) return result;
+
+    // Centre the points
+    vector<ld> u(M);
+    for (size_t j = 0; j < M; ++j) u[j] = log(xs[j]);
+    const ld u_lo = *min_element(u.begin(), u.end());
+    const ld u_hi = *max_element(u.begin(), u.end());
+    const double u_c = double(0.5L * (u_lo + u_hi));
+    const double S = max(double(0.5L * (u_hi - u_lo)), 1.0);
+
+    // Rounding floor of the largest band grid
+    const double G = double(0.5L * ((zeros.end() - 1)->gamma() - zeros.begin()->gamma()));
+    const double points = min(G * (2.0 * S) / M_PI, double(NUFFT_MAX_HALF));
+    eps = max({ eps, NUFFT_MIN_EPS, NUFFT_ROUNDOFF * points });
+    if (stats) stats->eps = eps;
+
+    // Widest band: G / dg + w1 <= NUFFT_MAX_HALF, less a margin
+    // for the rounding of ceil and of the band's centre
+    const NufftGrid grid(S, eps);
+    const ld band = 2.0L * ld(NUFFT_MAX_HALF - grid.w1 - 2) * grid.dg;
+
+    for (const ZetaZero* first = zeros.begin(); first != zeros.end(); ) {
+        const ld top = first->gamma() + band;
+        const ZetaZero* last = upper_bound(first, zeros.end(), top,
+            [](ld t, const ZetaZero& z) { return t < z.gamma(); });
+        if (last == first) ++last;
+        zero_sum_nufft_band(xs, u, u_c, S, { first, size_t(last - first) }, eps, result, stats);
+        if (stats) ++stats->bands;
+        first = last;
+    }
+
+    if (stats)
+        for (const auto& z : zeros) stats->weight += double(1.0L / abs(cplx(0.5L, z.gamma())));
+    return result;
+}
+
+// ψ(x) from the explicit formula at every x_j, via zero_sum_nufft
+vector<ld> psi_explicit_many(const vector<ld>& xs, ZeroSpan zeros, double eps,
+                             NufftStats* stats = nullptr) {
+    vector<cplx> sums = zero_sum_nufft(xs, zeros, eps, stats);
+    vector<ld> psi(xs.size());
+    for (size_t j = 0; j < xs.size(); ++j) {
+        ld x = xs[j];
+        psi[j] = x - 2.0L * real(sums[j]) - log(2.0L * M_PIl) - 0.5L * log(1.0L - pow(x, -2.0L));
+    }
     return psi;
 }
 
 // ---------------------------------------------------------
-// Load a small demonstration set of zeta zeros
-// (Replace with real datasets for serious research)
+// Exact ψ(x): segmented sieve of Eratosthenes (ground truth)
+// Odd numbers coprime to 30 are kept one bit each, eight bits
+// per 30 integers (mod-30 wheel). Segments are sized for L2;
+// threads take blocks of consecutive segments from an atomic
+// counter, so each prime's next multiple is found once per
+// block and then carried from segment to segment. A prime p
+// crosses off p*q for q on the wheel by table-driven byte and
+// bit steps, without divisions.
+//
+// log p is summed as the log of a running product: 16 primes
+// below 2^44 fit in a double, after which the binary exponent
+// is moved to an integer, so there is one multiply per prime
+// instead of one log. Every checkpoint is resolved in the same
+// sweep; prime powers p^k, k >= 2, are merged in afterwards.
 // ---------------------------------------------------------
-vector<ZetaZero> load_demo_zeros() {
-    vector<ZetaZero> zeros = {
-        {14.1347251417347L},
-        {21.0220396387716L},
-        {25.0108575801457L},
-        {30.4248761258595L},
-        {32.9350615877392L},
-        {37.5861781588257L},
-        {40.9187190121475L}
+constexpr int WHEEL_RESIDUES[8] = { 1, 7, 11, 13, 17, 19, 23, 29 };
+constexpr int WHEEL_STEPS[8] = { 6, 4, 2, 4, 2, 4, 6, 2 };
+constexpr size_t SIEVE_SEGMENT_BYTES = size_t(1) << 18;   // 7.8e6 integers
+constexpr size_t SIEVE_BLOCK_SEGMENTS = 16;
+
+struct SieveTables {
+    int8_t bit_of[30];            // residue -> bit, -1 off the wheel
+    uint8_t mask[8][8];           // [p mod 30][q index]: bit of p*q
+    uint8_t carry[8][8];          // extra byte step beyond (p/30)*step
+
+    SieveTables() {
+        fill(begin(bit_of), end(bit_of), int8_t(-1));
+        for (int b = 0; b < 8; ++b) bit_of[WHEEL_RESIDUES[b]] = int8_t(b);
+        for (int r = 0; r < 8; ++r)
+            for (int i = 0; i < 8; ++i) {
+                int rp = WHEEL_RESIDUES[r], rq = WHEEL_RESIDUES[i], next = rq + WHEEL_STEPS[i];
+                mask[r][i] = uint8_t(1u << bit_of[(rp * rq) % 30]);
+                carry[r][i] = uint8_t((rp * next) / 30 - (rp * rq) / 30);
+            }
+    }
+};
+
+struct PsiCheckpoint {
+    uint64_t x;
+    uint64_t primes = 0;          // π(x)
+    ld theta = 0.0L;              // sum of log p, p <= x
+    ld psi = 0.0L;                // theta plus prime powers
+};
+
+// Primes up to n, plain sieve
+vector<uint32_t> primes_up_to(uint32_t n) {
+    vector<bool> composite(size_t(n) + 1, false);
+    vector<uint32_t> primes;
+    for (uint64_t p = 2; p <= n; ++p) {
+        if (composite[p]) continue;
+        primes.push_back(uint32_t(p));
+        for (uint64_t m = p * p; m <= n; m += p) composite[m] = true;
+    }
+    return primes;
+}
+
+// Running sum of logs kept as mantissa * 2^exponent
+struct LogProduct {
+    double mantissa = 1.0;
+    int64_t exponent = 0;
+    int pending = 0;
+    uint64_t count = 0;
+
+    void multiply(uint64_t n) {
+        mantissa *= double(n);
+        ++count;
+        if (++pending == 16) normalize();
+    }
+
+    // Move the binary exponent out, leaving mantissa in [1, 2)
+    void normalize() {
+        uint64_t bits;
+        memcpy(&bits, &mantissa, sizeof bits);
+        exponent += int64_t((bits >> 52) & 0x7ff) - 1023;
+        bits = (bits & ~(uint64_t(0x7ff) << 52)) | (uint64_t(1023) << 52);
+        memcpy(&mantissa, &bits, sizeof bits);
+        pending = 0;
+    }
+
+    ld value() const { return ld(exponent) * logl(2.0L) + logl(ld(mantissa)); }
+};
+
+// Exact π, θ and ψ at every checkpoint (any order, x >= 1)
+vector<PsiCheckpoint> psi_exact(const vector<uint64_t>& xs, int threads) {
+    static const SieveTables tables;
+    vector<PsiCheckpoint> result;
+    for (uint64_t x : xs) result.push_back({ x });
+    if (xs.empty()) return result;
+
+    vector<size_t> order(xs.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    sort(order.begin(), order.end(), [&](size_t a, size_t b) { return xs[a] < xs[b]; });
+    const uint64_t x_max = xs[order.back()];
+
+    uint32_t root = uint32_t(sqrtl(ld(x_max)));
+    while (uint64_t(root + 1) * (root + 1) <= x_max) ++root;
+    const vector<uint32_t> small = primes_up_to(max<uint32_t>(root, 7));
+    const size_t first_wheel_prime = 3;           // small[3] = 7
+
+    const uint64_t total_bytes = x_max / 30 + 1;
+    const uint64_t block_bytes = SIEVE_SEGMENT_BYTES * SIEVE_BLOCK_SEGMENTS;
+    const size_t blocks = size_t((total_bytes + block_bytes - 1) / block_bytes);
+
+    // Checkpoints ordered by byte, and the first one at or after each block
+    vector<uint64_t> sorted_x(order.size());
+    for (size_t i = 0; i < order.size(); ++i) sorted_x[i] = xs[order[i]];
+    vector<ld> block_theta(blocks, 0.0L), partial_theta(order.size(), 0.0L);
+    vector<uint64_t> block_count(blocks, 0), partial_count(order.size(), 0);
+
+    atomic<size_t> next_block(0);
+    auto worker = [&]() {
+        vector<uint8_t> segment(SIEVE_SEGMENT_BYTES);
+        vector<uint64_t> next_byte(small.size());
+        vector<uint8_t> next_index(small.size());
+
+        for (size_t block; (block = next_block++) < blocks;) {
+            const uint64_t lo = block * block_bytes;
+            const uint64_t hi = min(total_bytes, lo + block_bytes);
+            const uint64_t lo_number = 30 * lo, hi_number = 30 * hi;
+
+            // First multiple p*q >= max(p^2, lo_number) with q on the wheel
+            size_t active = first_wheel_prime;
+            for (size_t k = first_wheel_prime; k < small.size(); ++k) {
+                uint64_t p = small[k];
+                if (p * p >= hi_number) break;
+                uint64_t q = max<uint64_t>(p, (lo_number + p - 1) / p);
+                while (tables.bit_of[q % 30] < 0) ++q;
+                next_byte[k] = (p * q) / 30;
+                next_index[k] = uint8_t(tables.bit_of[q % 30]);
+                active = k + 1;
+            }
+
+            LogProduct product;
+            size_t c = size_t(lower_bound(sorted_x.begin(), sorted_x.end(), lo_number) - sorted_x.begin());
+
+            for (uint64_t seg = lo; seg < hi; seg += SIEVE_SEGMENT_BYTES) {
+                const uint64_t end = min(hi, seg + SIEVE_SEGMENT_BYTES);
+                const uint64_t end_number = 30 * end;
+                fill(segment.begin(), segment.begin() + (end - seg), uint8_t(0xff));
+                if (seg == 0) segment[0] &= uint8_t(~1u);   // 1 is not prime
+
+                for (size_t k = first_wheel_prime; k < active; ++k) {
+                    const uint64_t p = small[k];
+                    if (p * p >= end_number) break;
+                    const uint64_t a = p / 30;
+                    const int r = tables.bit_of[p % 30];
+                    uint64_t byte = next_byte[k];
+                    int i = next_index[k];
+                    auto step = [&]() {
+                        segment[byte - seg] &= uint8_t(~tables.mask[r][i]);
+                        byte += a * WHEEL_STEPS[i] + tables.carry[r][i];
+                        i = (i + 1) & 7;
+                    };
+                    while (i != 0 && byte < end) step();
+                    // A full turn of the wheel (q += 30) moves p bytes on
+                    // and hits the same eight bits: unroll it
+                    if (i == 0 && byte + p <= end) {
+                        uint64_t offset[8];
+                        uint8_t clear[8];
+                        for (int j = 0, o = 0; j < 8; ++j) {
+                            offset[j] = uint64_t(o);
+                            clear[j] = uint8_t(~tables.mask[r][j]);
+                            o += int(a * WHEEL_STEPS[j] + tables.carry[r][j]);
+                        }
+                        uint8_t* s = segment.data() - seg;
+                        for (; byte + p <= end; byte += p) {
+                            s[byte + offset[0]] &= clear[0];
+                            s[byte + offset[1]] &= clear[1];
+                            s[byte + offset[2]] &= clear[2];
+                            s[byte + offset[3]] &= clear[3];
+                            s[byte + offset[4]] &= clear[4];
+                            s[byte + offset[5]] &= clear[5];
+                            s[byte + offset[6]] &= clear[6];
+                            s[byte + offset[7]] &= clear[7];
+                        }
+                    }
+                    while (byte < end) step();
+                    next_byte[k] = byte;
+                    next_index[k] = uint8_t(i);
+                }
+
+                // Accumulate bytes [from, to), keeping bits in keep
+                auto accumulate = [&](uint64_t from, uint64_t to, uint8_t keep) {
+                    for (uint64_t byte = from; byte < to; ++byte) {
+                        unsigned bits = segment[byte - seg] & keep;
+                        while (bits) {
+                            int b = __builtin_ctz(bits);
+                            bits &= bits - 1;
+                            product.multiply(30 * byte + WHEEL_RESIDUES[b]);
+                        }
+                    }
+                };
+
+                uint64_t pos = seg;
+                for (; c < sorted_x.size() && sorted_x[c] < end_number; ++c) {
+                    const uint64_t x = sorted_x[c];
+                    const uint64_t byte = x / 30;
+                    uint8_t below = 0;
+                    for (int b = 0; b < 8; ++b)
+                        if (uint64_t(WHEEL_RESIDUES[b]) <= x % 30) below |= uint8_t(1u << b);
+                    if (byte > pos) {
+                        accumulate(pos, byte, 0xff);
+                        pos = byte;
+                    }
+                    // Byte of x: bits at or below x now, the rest later
+                    LogProduct before = product;
+                    accumulate(byte, byte + 1, below);
+                    partial_theta[c] = product.value();
+                    partial_count[c] = product.count;
+                    product = before;
+                }
+                accumulate(pos, end, 0xff);
+            }
+            block_theta[block] = product.value();
+            block_count[block] = product.count;
+        }
     };
-    return zeros;
+
+    vector<thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+
+    // Prefix over blocks (compensated), then 2, 3, 5 and prime powers
+    vector<ld> theta_before(blocks + 1, 0.0L);
+    vector<uint64_t> count_before(blocks + 1, 0);
+    ld sum = 0.0L, compensation = 0.0L;
+    for (size_t b = 0; b < blocks; ++b) {
+        ld y = block_theta[b] - compensation;
+        ld t = sum + y;
+        compensation = (t - sum) - y;
+        sum = t;
+        theta_before[b + 1] = sum;
+        count_before[b + 1] = count_before[b] + block_count[b];
+    }
+
+    vector<pair<uint64_t, ld>> powers;            // (p^k, log p), k >= 2
+    for (uint32_t p : small) {
+        if (uint64_t(p) * p > x_max) break;
+        for (uint64_t q = uint64_t(p) * p; ; q *= p) {
+            powers.push_back({ q, logl(ld(p)) });
+            if (q > x_max / p) break;
+        }
+    }
+    sort(powers.begin(), powers.end());
+
+    ld power_sum = 0.0L;
+    size_t next_power = 0;
+    for (size_t c = 0; c < sorted_x.size(); ++c) {
+        const uint64_t x = sorted_x[c];
+        const size_t block = size_t((x / 30) / block_bytes);
+        PsiCheckpoint& out = result[order[c]];
+        out.theta = theta_before[block] + partial_theta[c];
+        out.primes = count_before[block] + partial_count[c];
+        for (uint64_t p : { 2, 3, 5 })
+            if (x >= p) {
+                out.theta += logl(ld(p));
+                ++out.primes;
+            }
+        for (; next_power < powers.size() && powers[next_power].first <= x; ++next_power)
+            power_sum += powers[next_power].second;
+        out.psi = out.theta + power_sum;
+    }
+    return result;
+}
+
+// ---------------------------------------------------------
+// Smoothed explicit formula
+// The sharp sum over zeros converges like 1/gamma and rings
+// at every prime power. Averaging ψ over a window in log x,
+//     ψ_K(x) = ∫ ψ(x e^u) K(u) du,   K even, ∫ K = 1,
+// weights each zero term by K^(rho) = ∫ e^{rho u} K(u) du and
+// moves the main term from x to x K^(1):
+//     ψ_K(x) = x K^(1) - sum_rho x^rho K^(rho) / rho - log 2π
+//              - (1/2) ∫ log(1 - x^{-2} e^{-2u}) K(u) du.
+// Gaussian, K = N(0, w^2):     K^(s) = exp(w^2 s^2 / 2), so
+//   weights fall like exp(-w^2 gamma^2 / 2).
+// Fejér, K = triangle on [-w, w]:  K^(s) = (sinh(ws/2) / (ws/2))^2,
+//   the Fejér kernel in gamma, so weights fall like 1/gamma^2
+//   and ψ_K only sees ψ on [x e^{-w}, x e^{w}].
+//
+// Truncation at T is bounded by summing the weight envelope
+// f(gamma) over gamma > T with Trudgian's zero count
+//     |N(t) - (t/2π) log(t/2πe) - 7/8| <= R(t)
+//         = 0.112 log t + 0.278 log log t + 2.510,
+// which for f >= 0 decreasing gives
+//     sum_{gamma > T} f <= ∫_T^∞ f(t) (log(t/2π)/2π + R'(t)) dt
+//                          + 2 R(T) f(T).
+// The bound assumes the table holds every zero below T and
+// that zeros above T lie on the critical line (verified to
+// 3e12, beyond which both envelopes are negligible).
+// ---------------------------------------------------------
+enum class Kernel { Gaussian, Fejer };
+
+struct Smoothing {
+    Kernel kind;
+    ld width;                     // w: standard deviation, or triangle half-width
+
+    const char* name() const { return kind == Kernel::Gaussian ? "Gaussian" : "Fejér"; }
+
+    // |u| beyond which K vanishes (Fejér) or its tail mass is < 1e-23
+    ld reach() const { return kind == Kernel::Gaussian ? 10.0L * width : width; }
+
+    // K^(s) = ∫ e^{su} K(u) du
+    cplx transform(cplx s) const {
+        if (kind == Kernel::Gaussian) return exp(0.5L * width * width * s * s);
+        cplx z = 0.5L * width * s;
+        cplx ratio = sinh(z) / z;
+        return ratio * ratio;
+    }
+
+    ld density(ld u) const {
+        if (kind == Kernel::Gaussian)
+            return expl(-0.5L * u * u / (width * width)) / (width * sqrtl(2.0L * M_PIl));
+        return max(0.0L, 1.0L - fabsl(u) / width) / width;
+    }
+
+    // Mass of K above v: the weight ψ_K gives a prime power n = x e^v
+    ld tail_mass(ld v) const {
+        if (kind == Kernel::Gaussian) return 0.5L * erfcl(v / (width * sqrtl(2.0L)));
+        if (v <= -width) return 1.0L;
+        if (v >= width) return 0.0L;
+        ld r = (width - fabsl(v)) / width;
+        return v < 0.0L ? 1.0L - 0.5L * r * r : 0.5L * r * r;
+    }
+
+    // Rigorous bound on |sum over zeros with gamma > T| at x
+    ld truncation_bound(ld x, ld T) const {
+        if (T < 2.0L * M_PIl * M_El) return numeric_limits<ld>::infinity();
+        const ld R = 0.112L * logl(T) + 0.278L * logl(logl(T)) + 2.510L;
+        const ld dR = (0.112L + 0.278L / logl(T)) / T;          // bounds R'(t), t >= T
+        const ld density = logl(T / (2.0L * M_PIl)) / (2.0L * M_PIl);
+
+        if (kind == Kernel::Gaussian) {
+            // f(t) = 2 sqrt(x) e^{w^2/8} e^{-a t^2} / t; log(t/2π)/t decreases for t > 2πe
+            const ld a = 0.5L * width * width;
+            const ld scale = 2.0L * sqrtl(x) * expl(a / 4.0L);
+            const ld gauss_tail = 0.5L * sqrtl(M_PIl / a) * erfcl(sqrtl(a) * T);
+            return scale * ((density + dR) / T * gauss_tail + 2.0L * R * expl(-a * T * T) / T);
+        }
+        // |sinh z| <= cosh(Re z): f(t) = C / t^3
+        const ld c = cosh(0.25L * width);
+        const ld C = 2.0L * sqrtl(x) * 4.0L * c * c / (width * width);
+        const ld T2 = T * T;
+        return C * ((density + 0.5L / (2.0L * M_PIl)) / (2.0L * T2)
+                    + dR / (3.0L * T2) + 2.0L * R / (T2 * T));
+    }
+};
+
+// Explicit formula for ψ_K(x) over the given zeros
+ld psi_smoothed(ld x, ZeroSpan zeros, const Smoothing& kernel) {
+    cplx sum = 0.0L;
+    for (const auto& z : zeros) {
+        cplx term = x_to_rho_over_rho(x, z) * kernel.transform(cplx(0.5L, z.gamma()));
+        sum += term;
+        sum += conj(term);
+    }
+
+    // Trivial zeros averaged over the window (Simpson)
+    const int nodes = 256;
+    const ld reach = kernel.reach(), h = 2.0L * reach / nodes;
+    ld trivial = 0.0L;
+    for (int i = 0; i <= nodes; ++i) {
+        ld u = -reach + i * h;
+        ld weight = (i == 0 || i == nodes) ? 1.0L : (i % 2 ? 4.0L : 2.0L);
+        trivial += weight * log1pl(-expl(-2.0L * (logl(x) + u))) * kernel.density(u);
+    }
+    trivial *= h / 3.0L;
+
+    ld main_term = x * real(kernel.transform(cplx(1.0L, 0.0L)));
+    return main_term - real(sum) - log(2.0L * M_PIl) - 0.5L * trivial;
+}
+
+// Shortest prefix of the table whose truncation bound is <= tol
+ZeroSpan zeros_for_bound(ld x, ZeroSpan all, const Smoothing& kernel, ld tol) {
+    size_t lo = 1, hi = all.size();
+    if (all.empty() || kernel.truncation_bound(x, all.begin()[hi - 1].gamma()) > tol)
+        return all;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (kernel.truncation_bound(x, all.begin()[mid - 1].gamma()) <= tol) hi = mid;
+        else lo = mid + 1;
+    }
+    return { all.begin(), lo };
+}
+
+// Exact ψ_K(x): ψ below the window plus each prime power inside
+// it weighted by the kernel's tail mass. The window is sieved
+// directly, one byte per integer, in L2-sized segments.
+ld psi_smoothed_exact(uint64_t x, const Smoothing& kernel, int threads) {
+    const uint64_t lo = uint64_t(ld(x) * expl(-kernel.reach()));
+    const uint64_t hi = uint64_t(ld(x) * expl(kernel.reach()));
+    const ld log_x = logl(ld(x));
+    auto weight = [&](uint64_t n) { return kernel.tail_mass(logl(ld(n)) - log_x); };
+
+    ld sum = psi_exact({ lo }, threads)[0].psi;
+    const vector<uint32_t> small = primes_up_to(uint32_t(sqrtl(ld(hi))) + 1);
+
+    vector<uint8_t> composite(SIEVE_SEGMENT_BYTES);
+    for (uint64_t seg = lo + 1; seg <= hi; seg += SIEVE_SEGMENT_BYTES) {
+        const uint64_t end = min<uint64_t>(hi + 1, seg + SIEVE_SEGMENT_BYTES);
+        fill(composite.begin(), composite.end(), uint8_t(0));
+        for (uint32_t p : small) {
+            uint64_t start = max<uint64_t>(uint64_t(p) * p, (seg + p - 1) / p * p);
+            for (uint64_t m = start; m < end; m += p) composite[m - seg] = 1;
+        }
+        for (uint64_t n = max<uint64_t>(seg, 2); n < end; ++n)
+            if (!composite[n - seg]) sum += logl(ld(n)) * weight(n);
+    }
+    for (uint32_t p : small)
+        for (uint64_t q = uint64_t(p) * p; q <= hi; q *= p) {
+            if (q > lo) sum += logl(ld(p)) * weight(q);
+            if (q > hi / p) break;
+        }
+    return sum;
+}
+
+// ---------------------------------------------------------
+// Binary zero table
+// Layout: ZeroFileHeader, zero padding to ZERO_FILE_OFFSET,
+// then count ZetaZero records in increasing height. The file
+// is mapped read-only, so opening is instant whatever its
+// size and pages are read only when a sum reaches them.
+// ---------------------------------------------------------
+struct ZeroFileHeader {
+    char magic[8];            // "ZETAZRO"
+    uint32_t version;
+    uint32_t record_bytes;    // sizeof(ZetaZero)
+    uint64_t count;
+    uint64_t offset;          // first record
+    double first_height;
+    double last_height;
+};
+
+constexpr char ZERO_FILE_MAGIC[8] = "ZETAZRO";
+constexpr uint64_t ZERO_FILE_OFFSET = 4096;
+
+class ZeroTable {
+public:
+    ZeroTable() = default;
+    ZeroTable(const ZeroTable&) = delete;
+    ZeroTable& operator=(const ZeroTable&) = delete;
+    ~ZeroTable() { close(); }
+
+    // Map a table written by import_zero_text
+    bool open(const string& path, string& error) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            error = "cannot open " + path;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < off_t(sizeof(ZeroFileHeader))) {
+            ::close(fd);
+            error = path + " is not a zero table";
+            return false;
+        }
+        bytes = size_t(st.st_size);
+        void* p = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            error = "cannot map " + path;
+            bytes = 0;
+            return false;
+        }
+        base = static_cast<const unsigned char*>(p);
+
+        const ZeroFileHeader& h = *reinterpret_cast<const ZeroFileHeader*>(base);
+        if (memcmp(h.magic, ZERO_FILE_MAGIC, sizeof h.magic) != 0 || h.version != 1
+            || h.record_bytes != sizeof(ZetaZero)) {
+            error = path + " is not a zero table";
+        } else if (h.offset % alignof(ZetaZero) != 0
+                   || h.offset > bytes
+                   || h.count > (bytes - h.offset) / sizeof(ZetaZero)) {
+            error = path + " is truncated";
+        } else {
+            zeros = { reinterpret_cast<const ZetaZero*>(base + h.offset), size_t(h.count) };
+            source = path;
+            return true;
+        }
+        close();
+        return false;
+    }
+
+    // Small demonstration set of zeta zeros
+    // (Replace with real datasets for serious research)
+    void use_demo() {
+        close();
+        demo = {
+            {14.1347251417347, 0.0},
+            {21.0220396387716, 0.0},
+            {25.0108575801457, 0.0},
+            {30.4248761258595, 0.0},
+            {32.9350615877392, 0.0},
+            {37.5861781588257, 0.0},
+            {40.9187190121475, 0.0}
+        };
+        zeros = { demo.data(), demo.size() };
+        source = "built-in demo zeros";
+    }
+
+    void close() {
+        if (base) munmap(const_cast<unsigned char*>(base), bytes);
+        base = nullptr;
+        bytes = 0;
+        demo.clear();
+        zeros = {};
+        source.clear();
+    }
+
+    ZeroSpan all() const { return zeros; }
+    ZeroSpan up_to(ld T) const { return zeros.up_to(T); }
+    const string& name() const { return source; }
+
+private:
+    const unsigned char* base = nullptr;
+    size_t bytes = 0;
+    vector<ZetaZero> demo;
+    ZeroSpan zeros;
+    string source;
+};
+
+// ---------------------------------------------------------
+// Plain-text importer
+// One zero per line, height in the last column, so both bare
+// lists (Odlyzko's zeros1 ...) and "index height" tables are
+// read. Blank lines and lines starting with '#' are skipped.
+// Heights are parsed in long double and split into hi + lo.
+// Records are streamed, so tables larger than memory work.
+// ---------------------------------------------------------
+bool import_zero_text(const string& text_path, const string& table_path,
+                      uint64_t& count, string& error) {
+    ifstream in(text_path);
+    if (!in) {
+        error = "cannot open " + text_path;
+        return false;
+    }
+    const string tmp = table_path + ".tmp";
+    ofstream out(tmp, ios::binary | ios::trunc);
+    if (!out) {
+        error = "cannot create " + tmp;
+        return false;
+    }
+
+    ZeroFileHeader h{};
+    memcpy(h.magic, ZERO_FILE_MAGIC, sizeof h.magic);
+    h.version = 1;
+    h.record_bytes = sizeof(ZetaZero);
+    h.offset = ZERO_FILE_OFFSET;
+    vector<char> padding(ZERO_FILE_OFFSET, 0);
+    out.write(padding.data(), padding.size());
+
+    vector<ZetaZero> block;
+    block.reserve(1 << 16);
+    string line, field;
+    ld previous = 0.0L;
+    uint64_t line_number = 0;
+    count = 0;
+
+    while (getline(in, line)) {
+        ++line_number;
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == string::npos || line[start] == '#') continue;
+
+        istringstream fields(line);
+        string last;
+        while (fields >> field) last = field;
+        char* end = nullptr;
+        ld gamma = strtold(last.c_str(), &end);
+        if (end == last.c_str() || *end != '\0' || !(gamma > previous)) {
+            error = text_path + ":" + to_string(line_number)
+                  + ": expected a height above the previous one";
+            out.close();
+            remove(tmp.c_str());
+            return false;
+        }
+        previous = gamma;
+
+        double hi = double(gamma);
+        block.push_back({ hi, double(gamma - ld(hi)) });
+        if (count++ == 0) h.first_height = hi;
+        h.last_height = hi;
+
+        if (block.size() == block.capacity()) {
+            out.write(reinterpret_cast<const char*>(block.data()), block.size() * sizeof(ZetaZero));
+            block.clear();
+        }
+    }
+    out.write(reinterpret_cast<const char*>(block.data()), block.size() * sizeof(ZetaZero));
+
+    h.count = count;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&h), sizeof h);
+    out.close();
+    if (!out || rename(tmp.c_str(), table_path.c_str()) != 0) {
+        remove(tmp.c_str());
+        error = "cannot write " + table_path;
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------
+// Open a binary table, or import a text table next to it.
+// An earlier import is reused while it is at least as new
+// as the text it came from.
+// ---------------------------------------------------------
+bool newer_or_same(const string& path, const string& than) {
+    struct stat a, b;
+    if (stat(path.c_str(), &a) != 0 || stat(than.c_str(), &b) != 0) return false;
+    if (a.st_mtim.tv_sec != b.st_mtim.tv_sec) return a.st_mtim.tv_sec > b.st_mtim.tv_sec;
+    return a.st_mtim.tv_nsec >= b.st_mtim.tv_nsec;
+}
+
+bool load_zero_table(ZeroTable& table, const string& path) {
+    if (path == "-") {
+        table.use_demo();
+        return true;
+    }
+
+    string error;
+    if (table.open(path, error)) return true;
+
+    ifstream probe(path);
+    if (!probe) {
+        cout << "Cannot load zeros: " << error << "\n";
+        return false;
+    }
+
+    string binary = path + ".zeros";
+    string stale;
+    if (newer_or_same(binary, path) && table.open(binary, stale)) {
+        cout << "Using " << binary << " (imported from " << path << ").\n";
+        return true;
+    }
+    cout << path << " is not a binary table; importing it as text into "
+         << binary << " ...\n";
+    uint64_t count = 0;
+    if (!import_zero_text(path, binary, count, error) || !table.open(binary, error)) {
+        cout << "Cannot load zeros: " << error << "\n";
+        return false;
+    }
+    cout << "Imported " << count << " zeros.\n";
+    return true;
+}
+
+// ---------------------------------------------------------
+// Tabulation of ψ(x) − x over many x (NUFFT mode)
+// The error bound is checked against psi_explicit at a few
+// of the points; the CSV holds x, ψ(x) and ψ(x) − x.
+// ---------------------------------------------------------
+void tabulate_psi(const ZeroTable& table) {
+    ld x0, x1, T;
+    size_t count;
+    int log_spacing;
+    double eps;
+    string csv;
+
+    cout << "Range x0 x1: ";
+    cin >> x0 >> x1;
+    cout << "Number of points: ";
+    cin >> count;
+    cout << "Spacing (0 = linear, 1 = logarithmic): ";
+    cin >> log_spacing;
+    cout << "Truncation height T (0 = every loaded zero): ";
+    cin >> T;
+    cout << "Accuracy eps (e.g. 1e-10): ";
+    cin >> eps;
+    cout << "CSV output file (or - for none): ";
+    cin >> csv;
+
+    if (!cin || x0 < 10.0L || x1 < x0 || count == 0 || !(eps > 0.0 && eps < 1.0)) {
+        cout << "Need 10 <= x0 <= x1, at least one point and 0 < eps < 1.\n\n";
+        return;
+    }
+
+    vector<ld> xs(count);
+    for (size_t j = 0; j < count; ++j) {
+        ld f = (count > 1) ? ld(j) / ld(count - 1) : 0.0L;
+        xs[j] = log_spacing ? x0 * pow(x1 / x0, f) : x0 + (x1 - x0) * f;
+    }
+    ZeroSpan zeros = (T > 0.0L) ? table.up_to(T) : table.all();
+
+    auto start = chrono::steady_clock::now();
+    NufftStats stats;
+    vector<ld> psi = psi_explicit_many(xs, zeros, eps, &stats);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "\n" << count << " points, " << zeros.size() * 2 << " zeros: "
+         << setprecision(3) << seconds << " s (FFT length " << stats.grid
+         << (stats.bands > 1 ? ", " + to_string(stats.bands) + " height bands" : string())
+         << ", kernel half-widths " << stats.spread_g << " / " << stats.spread_s << ")\n";
+    if (stats.eps > eps)
+        cout << scientific << setprecision(1) << "eps raised to " << stats.eps
+             << ", the rounding floor of this grid\n" << fixed;
+    eps = stats.eps;
+
+    // Spot check: |error| <= 2 eps sqrt(x) sum |1/rho| per point
+    const size_t checks = min<size_t>(count, 8);
+    ld worst = 0.0L, worst_ratio = 0.0L;
+    for (size_t c = 0; c < checks; ++c) {
+        size_t j = (checks > 1) ? c * (count - 1) / (checks - 1) : 0;
+        ld error = fabsl(psi[j] - psi_explicit(xs[j], zeros));
+        ld bound = 2.0L * eps * sqrt(xs[j]) * stats.weight;
+        worst = max(worst, error);
+        worst_ratio = max(worst_ratio, error / bound);
+    }
+    cout << scientific << "Direct check at " << checks << " points: max |error| = " << worst
+         << " (" << worst_ratio << " of the eps bound)\n" << fixed << setprecision(12);
+
+    if (csv != "-") {
+        ofstream out(csv);
+        out << "x,psi,delta\n" << setprecision(18);
+        for (size_t j = 0; j < count; ++j)
+            out << xs[j] << "," << psi[j] << "," << psi[j] - xs[j] << "\n";
+        cout << (out ? "Wrote " : "Could not write ") << csv << "\n";
+    }
+    cout << "\n---------------------------------------------\n\n";
+}
+
+// ---------------------------------------------------------
+// Exact ψ(x) against the explicit formula
+// Checkpoints are log-spaced integers; the explicit formula is
+// evaluated at x + 1/2, where ψ has no jump.
+// ---------------------------------------------------------
+void exact_psi_mode(const ZeroTable& table) {
+    uint64_t x_max;
+    size_t count;
+    int threads;
+    string csv;
+
+    cout << "Largest x (1e13 takes a while): ";
+    ld x_in;
+    cin >> x_in;
+    cout << "Number of checkpoints (log-spaced from 100 up to x): ";
+    cin >> count;
+    cout << "Threads (0 = all cores): ";
+    cin >> threads;
+    cout << "CSV output file (or - for none): ";
+    cin >> csv;
+
+    if (!cin || x_in < 100.0L || x_in > 1e18L || count == 0) {
+        cout << "Need 100 <= x <= 1e18 and at least one checkpoint.\n\n";
+        return;
+    }
+    x_max = uint64_t(x_in);
+    if (threads <= 0) threads = max(1u, thread::hardware_concurrency());
+
+    vector<uint64_t> xs;
+    for (size_t j = 0; j < count; ++j) {
+        ld f = (count > 1) ? ld(j) / ld(count - 1) : 1.0L;
+        xs.push_back(uint64_t(100.0L * pow(ld(x_max) / 100.0L, f)));
+    }
+    xs.back() = x_max;
+    xs.erase(unique(xs.begin(), xs.end()), xs.end());
+
+    auto start = chrono::steady_clock::now();
+    vector<PsiCheckpoint> exact = psi_exact(xs, threads);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    vector<ld> shifted;
+    for (uint64_t x : xs) shifted.push_back(ld(x) + 0.5L);
+    NufftStats stats;
+    vector<ld> explicit_psi = psi_explicit_many(shifted, table.all(), 1e-10, &stats);
+
+    cout << "\nSieved up to " << x_max << " on " << threads << " thread(s) in "
+         << setprecision(2) << seconds << " s; explicit formula by NUFFT, eps "
+         << scientific << setprecision(1) << stats.eps << fixed << "\n\n";
+    cout << setw(20) << "x" << setw(16) << "pi(x)" << setw(26) << "psi(x)"
+         << setw(18) << "psi(x) - x" << setw(18) << "explicit - exact" << "\n";
+    const size_t rows = min<size_t>(xs.size(), 12);
+    for (size_t r = 0; r < rows; ++r) {
+        size_t j = (rows > 1) ? r * (xs.size() - 1) / (rows - 1) : 0;
+        cout << setw(20) << xs[j] << setw(16) << exact[j].primes
+             << setw(26) << setprecision(6) << exact[j].psi
+             << setw(18) << exact[j].psi - ld(xs[j])
+             << setw(18) << explicit_psi[j] - exact[j].psi << "\n";
+    }
+    cout << setprecision(12);
+
+    if (csv != "-") {
+        ofstream out(csv);
+        out << "x,pi,theta,psi,psi_minus_x,explicit_minus_exact\n" << setprecision(18);
+        for (size_t j = 0; j < xs.size(); ++j)
+            out << xs[j] << "," << exact[j].primes << "," << exact[j].theta << ","
+                << exact[j].psi << "," << exact[j].psi - ld(xs[j]) << ","
+                << explicit_psi[j] - exact[j].psi << "\n";
+        cout << (out ? "Wrote " : "Could not write ") << csv << "\n";
+    }
+    cout << "\n---------------------------------------------\n\n";
+}
+
+// ---------------------------------------------------------
+// Smoothed against sharp explicit formula
+// Zeros are taken from the bottom of the table until the
+// rigorous truncation bound drops below the tolerance. For
+// x up to 1e12 both ψ_K(x) and ψ(x) are also sieved, so the
+// actual errors of the smoothed and the sharp sums can be set
+// against each other.
+// ---------------------------------------------------------
+void smoothed_psi_mode(const ZeroTable& table) {
+    ld x, width, tol;
+    int kind, threads;
+
+    cout << "Enter x: ";
+    cin >> x;
+    cout << "Kernel (1 = Gaussian, 2 = Fejér): ";
+    cin >> kind;
+    cout << "Width w in log x (the window is x e^{±w}, e.g. 1e-3): ";
+    cin >> width;
+    cout << "Tolerance for the truncation bound (e.g. 0.5): ";
+    cin >> tol;
+    cout << "Threads for the sieve check (0 = all cores): ";
+    cin >> threads;
+
+    const Smoothing kernel{ kind == 2 ? Kernel::Fejer : Kernel::Gaussian, width };
+    if (!cin || (kind != 1 && kind != 2) || !(width > 0.0L && width <= 0.1L) || !(tol > 0.0L)
+        || x * expl(-kernel.reach()) < 10.0L) {
+        cout << "Need kernel 1 or 2, 0 < w <= 0.1, tol > 0 and x e^{-reach} >= 10.\n\n";
+        return;
+    }
+    if (threads <= 0) threads = max(1u, thread::hardware_concurrency());
+
+    ZeroSpan all = table.all();
+    ZeroSpan zeros = zeros_for_bound(x, all, kernel, tol);
+    ld T = zeros.empty() ? 0.0L : (zeros.end() - 1)->gamma();
+    ld bound = kernel.truncation_bound(x, T);
+    ld smoothed = psi_smoothed(x, zeros, kernel);
+
+    cout << "\n" << kernel.name() << " kernel, w = " << scientific << setprecision(3) << width
+         << fixed << ": " << zeros.size() * 2 << " zeros, T = " << setprecision(3) << T << "\n";
+    if (bound > tol) cout << "The table ends before the bound reaches the tolerance.\n";
+    cout << setprecision(6)
+         << "Main term x K^(1)      = " << x * real(kernel.transform(cplx(1.0L, 0.0L))) << "\n"
+         << "ψ_K(x) explicit        = " << smoothed << "\n"
+         << "Truncation bound       = " << scientific << bound << fixed << "\n";
+
+    const ld sieve_limit = 1e12L, window_limit = 2e9L;
+    ld window = x * (expl(kernel.reach()) - expl(-kernel.reach()));
+    if (x > sieve_limit || window > window_limit) {
+        cout << "(x or the window is too large for the sieve check)\n";
+    } else {
+        const uint64_t n = uint64_t(x);
+        ld exact_smoothed = psi_smoothed_exact(n, kernel, threads);
+        ld exact = psi_exact({ n }, threads)[0].psi;
+        ld sharp = psi_explicit(ld(n) + 0.5L, zeros);
+        ld sharp_all = psi_explicit(ld(n) + 0.5L, all);
+        cout << "ψ_K(x) by sieve        = " << exact_smoothed << "   error "
+             << scientific << smoothed - exact_smoothed << fixed << "\n"
+             << "ψ(x) by sieve          = " << exact << "\n"
+             << "Sharp, same zeros      error " << scientific << sharp - exact << "\n"
+             << "Sharp, all " << all.size() * 2 << " zeros   error " << sharp_all - exact
+             << fixed << "\n";
+    }
+    cout << setprecision(12) << "\n---------------------------------------------\n\n";
 }
 
 // ---------------------------------------------------------
@@ -87,23 +1324,57 @@ int main() {
     cout << " ψ(x) − x via Explicit Formula\n";
     cout << "=============================================\n\n";
 
-    vector<ZetaZero> zeros = load_demo_zeros();
+    ZeroTable table;
+    string path;
+    cout << "Zero table (binary table, plain-text list to import, or - for demo zeros): ";
+    cin >> path;
+    if (!cin || !load_zero_table(table, path)) return 1;
+
+    ZeroSpan all = table.all();
+    cout << "Loaded " << all.size() << " zeros from " << table.name();
+    if (!all.empty())
+        cout << ", heights " << setprecision(3) << all.begin()->gamma()
+             << " .. " << (all.end() - 1)->gamma() << setprecision(12);
+    cout << "\n\n";
 
     while (true) {
-        ld x;
-        cout << "Enter x (e.g., 1e20) or 0 to exit: ";
-        cin >> x;
+        int mode;
+        cout << "1) ψ(x) at one x   2) Tabulate ψ(x) − x over many x (NUFFT)\n"
+             << "3) Exact ψ(x) by sieve vs explicit formula\n"
+             << "4) Smoothed ψ(x) (Gaussian / Fejér) with truncation bound   0) Exit\n> ";
+        cin >> mode;
 
-        if (!cin || x == 0.0L) {
+        if (!cin || mode == 0) {
             cout << "\nExiting program.\n";
             break;
         }
+        if (mode == 2) {
+            tabulate_psi(table);
+            continue;
+        }
+        if (mode == 3) {
+            exact_psi_mode(table);
+            continue;
+        }
+        if (mode == 4) {
+            smoothed_psi_mode(table);
+            continue;
+        }
+
+        ld x;
+        cout << "Enter x (e.g., 1e20): ";
+        cin >> x;
 
         if (x < 10.0L) {
             cout << "x must be large for asymptotic validity.\n\n";
             continue;
         }
 
+        ld T;
+        cout << "Truncation height T (0 = every loaded zero): ";
+        cin >> T;
+        ZeroSpan zeros = (T > 0.0L) ? table.up_to(T) : all;
+
         cout << "\nComputing ψ(x) using explicit formula...\n";
         cout << "Number of zeta zeros used: " << zeros.size() * 2 << "\n";
 
@@ -2,6 +2,18 @@
 #include <complex>
 #include <cmath>
 #include <iomanip>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 using namespace std;
 
@@ -10,6 +22,9 @@ static const double PI = acos(-1.0);
 // ===============================
 // Core Integrand
 // ===============================
+// The original integrand, evaluated point by point. The engine
+// below takes any rational integrand; on start-up its compiled
+// default is compared against this (defaultIntegrandMismatch).
 complex<double> integrand(double theta1, double theta2)
 {
     complex<double> i(0.0, 1.0);
@@ -27,30 +42,949 @@ complex<double> integrand(double theta1, double theta2)
     return jacobian / denominator;
 }
 
+// ===============================
+// Axis Tables
+// ===============================
+// z = r e^{iθ} depends on one angle only, so each axis is
+// tabulated once: R sin/cos pairs instead of R² exp calls.
+// Real and imaginary parts are kept in separate arrays so the
+// row loops below vectorize.
+struct AxisTable
+{
+    vector<double> re, im;
+
+    AxisTable() = default;
+
+    // θ_k = (k + offset) 2π / resolution on the circle |z| = radius
+    AxisTable(int resolution, double offset, double radius = 1.0)
+        : re(resolution), im(resolution)
+    {
+        double dtheta = 2.0 * PI / resolution;
+        for (int k = 0; k < resolution; ++k)
+        {
+            double theta = (k + offset) * dtheta;
+            re[k] = radius * cos(theta);
+            im[k] = radius * sin(theta);
+        }
+    }
+
+    int size() const { return int(re.size()); }
+
+    // The points with k != first (mod factor)
+    AxisTable without(int factor, int first) const
+    {
+        AxisTable out;
+        for (int k = 0; k < size(); ++k)
+            if ((k - first) % factor != 0)
+            {
+                out.re.push_back(re[k]);
+                out.im.push_back(im[k]);
+            }
+        return out;
+    }
+};
+
+// ===============================
+// Threading
+// ===============================
+// body(first, last) on a static split of [0, count) into
+// contiguous ranges, one per thread
+template <class Body>
+void parallelRows(int threads, int count, Body body)
+{
+    threads = max(1, min(threads, count));
+    vector<thread> pool;
+    for (int t = 1; t < threads; ++t)
+        pool.emplace_back([&body, t, threads, count]
+        {
+            body(int(1LL * count * t / threads), int(1LL * count * (t + 1) / threads));
+        });
+    body(0, int(1LL * count / threads));
+    for (auto& th : pool) th.join();
+}
+
+// ===============================
+// Polynomials in z1, z2
+// ===============================
+// Sparse coefficients a_{p,q} of z1^p z2^q with p, q >= 0
+const int MAX_DEGREE = 64;
+
+struct Polynomial
+{
+    map<pair<int, int>, complex<double>> terms;
+
+    static Polynomial constant(complex<double> c)
+    {
+        Polynomial out;
+        if (c != 0.0) out.terms[{ 0, 0 }] = c;
+        return out;
+    }
+
+    static Polynomial variable(int which)
+    {
+        Polynomial out;
+        out.terms[which == 1 ? make_pair(1, 0) : make_pair(0, 1)] = 1.0;
+        return out;
+    }
+
+    // Highest power of z1 (which = 1) or z2 (which = 2)
+    int degree(int which) const
+    {
+        int d = 0;
+        for (const auto& t : terms)
+            d = max(d, which == 1 ? t.first.first : t.first.second);
+        return d;
+    }
+
+    Polynomial operator+(const Polynomial& other) const
+    {
+        Polynomial out = *this;
+        for (const auto& t : other.terms) out.terms[t.first] += t.second;
+        return out;
+    }
+
+    Polynomial operator-(const Polynomial& other) const
+    {
+        Polynomial out = *this;
+        for (const auto& t : other.terms) out.terms[t.first] -= t.second;
+        return out;
+    }
+
+    Polynomial operator*(const Polynomial& other) const
+    {
+        Polynomial out;
+        for (const auto& a : terms)
+            for (const auto& b : other.terms)
+                out.terms[{ a.first.first + b.first.first, a.first.second + b.first.second }]
+                    += a.second * b.second;
+        return out;
+    }
+};
+
+// Recursive descent over
+//     expr   := term (('+' | '-') term)*
+//     term   := factor (['*'] factor)*
+//     factor := ('+' | '-') factor | atom ['^' integer]
+//     atom   := number ['i'] | 'i' | 'z1' | 'z2' | '(' expr ')'
+// A factor may follow another without '*' when it starts with
+// z, i or '(', as in 3z1z2 or 2i(z1 - 1). Products and powers
+// are expanded as they are parsed, so the result is a plain
+// coefficient table.
+class PolynomialParser
+{
+public:
+    explicit PolynomialParser(const string& text) : text(text) {}
+
+    Polynomial parse()
+    {
+        Polynomial out = expr();
+        if (peek() != '\0') fail("unexpected character");
+        return out;
+    }
+
+private:
+    const string& text;
+    size_t pos = 0;
+
+    [[noreturn]] void fail(const string& what) const
+    {
+        throw runtime_error(what + " at position " + to_string(pos + 1));
+    }
+
+    char peek()
+    {
+        while (pos < text.size() && isspace((unsigned char)text[pos])) ++pos;
+        return pos < text.size() ? text[pos] : '\0';
+    }
+
+    static void checkDegree(const Polynomial& p)
+    {
+        if (p.degree(1) > MAX_DEGREE || p.degree(2) > MAX_DEGREE)
+            throw runtime_error("degree above " + to_string(MAX_DEGREE));
+    }
+
+    Polynomial expr()
+    {
+        Polynomial out = term();
+        for (char c = peek(); c == '+' || c == '-'; c = peek())
+        {
+            ++pos;
+            out = (c == '+') ? out + term() : out - term();
+        }
+        return out;
+    }
+
+    Polynomial term()
+    {
+        Polynomial out = factor();
+        for (char c = peek(); c == '*' || c == 'z' || c == 'i' || c == '('; c = peek())
+        {
+            if (c == '*') ++pos;
+            out = out * factor();
+            checkDegree(out);
+        }
+        return out;
+    }
+
+    Polynomial factor()
+    {
+        char c = peek();
+        if (c == '+' || c == '-')
+        {
+            ++pos;
+            Polynomial inner = factor();
+            return (c == '-') ? Polynomial() - inner : inner;
+        }
+
+        Polynomial base = atom();
+        if (peek() != '^') return base;
+        ++pos;
+        peek();
+        size_t digits = pos;
+        while (pos < text.size() && isdigit((unsigned char)text[pos])) ++pos;
+        if (digits == pos) fail("expected an integer exponent");
+        int exponent = stoi(text.substr(digits, pos - digits));
+
+        Polynomial out = Polynomial::constant(1.0);
+        for (int e = 0; e < exponent; ++e)
+        {
+            out = out * base;
+            checkDegree(out);
+        }
+        return out;
+    }
+
+    Polynomial atom()
+    {
+        char c = peek();
+        if (c == '(')
+        {
+            ++pos;
+            Polynomial inner = expr();
+            if (peek() != ')') fail("expected ')'");
+            ++pos;
+            return inner;
+        }
+        if (c == 'z')
+        {
+            ++pos;
+            if (pos < text.size() && (text[pos] == '1' || text[pos] == '2'))
+                return Polynomial::variable(text[pos++] - '0');
+            fail("expected z1 or z2");
+        }
+        if (c == 'i')
+        {
+            ++pos;
+            return Polynomial::constant(complex<double>(0.0, 1.0));
+        }
+        if (isdigit((unsigned char)c) || c == '.')
+        {
+            const char* begin = text.c_str() + pos;
+            char* end = nullptr;
+            double value = strtod(begin, &end);
+            pos += size_t(end - begin);
+            if (pos < text.size() && text[pos] == 'i')
+            {
+                ++pos;
+                return Polynomial::constant(complex<double>(0.0, value));
+            }
+            return Polynomial::constant(value);
+        }
+        fail(c ? "unexpected character" : "unexpected end of input");
+    }
+};
+
+bool parsePolynomial(const string& text, Polynomial& out, string& error)
+{
+    try
+    {
+        out = PolynomialParser(text).parse();
+        return true;
+    }
+    catch (const exception& e)
+    {
+        error = e.what();
+        return false;
+    }
+}
+
+// ===============================
+// Compiled Rational Integrand
+// ===============================
+// A polynomial laid out for row evaluation: with z1 fixed it is
+// a polynomial in z2 whose coefficients b_q = sum_p a_{p,q} z1^p
+// are formed once per row (Horner in z1). Every point then costs
+// one complex multiply-add per degree in z2, run across a chunk
+// of points at a time on split real and imaginary arrays.
+struct RowHorner
+{
+    int degree1 = 0, degree2 = 0;
+    vector<complex<double>> coeff;            // a_{p,q} at q (degree1 + 1) + p
+
+    RowHorner() = default;
+
+    explicit RowHorner(const Polynomial& poly)
+        : degree1(poly.degree(1)), degree2(poly.degree(2)),
+          coeff(size_t(degree1 + 1) * (degree2 + 1))
+    {
+        for (const auto& t : poly.terms)
+            coeff[size_t(t.first.second) * (degree1 + 1) + t.first.first] = t.second;
+    }
+
+    // b_0 .. b_degree2 for this z1
+    void rowCoefficients(complex<double> z1, double* re, double* im) const
+    {
+        for (int q = 0; q <= degree2; ++q)
+        {
+            const complex<double>* a = &coeff[size_t(q) * (degree1 + 1)];
+            complex<double> b = a[degree1];
+            for (int p = degree1 - 1; p >= 0; --p) b = b * z1 + a[p];
+            re[q] = real(b);
+            im[q] = imag(b);
+        }
+    }
+
+    // acc_k = sum_q b_q z_k^q for k < len
+    void evaluate(const double* bRe, const double* bIm, const double* zRe, const double* zIm,
+                  int len, double* accRe, double* accIm) const
+    {
+        for (int k = 0; k < len; ++k)
+        {
+            accRe[k] = bRe[degree2];
+            accIm[k] = bIm[degree2];
+        }
+        for (int q = degree2 - 1; q >= 0; --q)
+            for (int k = 0; k < len; ++k)
+            {
+                double re = accRe[k] * zRe[k] - accIm[k] * zIm[k] + bRe[q];
+                double im = accRe[k] * zIm[k] + accIm[k] * zRe[k] + bIm[q];
+                accRe[k] = re;
+                accIm[k] = im;
+            }
+    }
+};
+
+const int ROW_CHUNK = 512;
+
+// f = -z1 z2 N / D, the θ-form of N / D dz1 dz2 on the torus
+struct RationalIntegrand
+{
+    string numeratorText, denominatorText;
+    RowHorner numerator, denominator;         // numerator includes -z1 z2
+    RowHorner plainNumerator;                 // N alone, for Laurent coefficients of N / D
+
+    RationalIntegrand(const string& numText, const Polynomial& num,
+                      const string& denText, const Polynomial& den)
+        : numeratorText(numText), denominatorText(denText),
+          numerator(num * Polynomial::variable(1) * Polynomial::variable(2) * Polynomial::constant(-1.0)),
+          denominator(den), plainNumerator(num)
+    {
+    }
+
+    // f(z1, z2_k) for k in [start, start + len), len <= ROW_CHUNK;
+    // N / D itself when thetaForm is false
+    void evaluateRow(complex<double> z1, const AxisTable& axis2, int start, int len,
+                     double* outRe, double* outIm, bool thetaForm = true) const
+    {
+        const RowHorner& top = thetaForm ? numerator : plainNumerator;
+        double nbRe[MAX_DEGREE + 2], nbIm[MAX_DEGREE + 2];
+        double dbRe[MAX_DEGREE + 2], dbIm[MAX_DEGREE + 2];
+        double numRe[ROW_CHUNK], numIm[ROW_CHUNK];
+        top.rowCoefficients(z1, nbRe, nbIm);
+        denominator.rowCoefficients(z1, dbRe, dbIm);
+
+        const double* zRe = axis2.re.data() + start;
+        const double* zIm = axis2.im.data() + start;
+        top.evaluate(nbRe, nbIm, zRe, zIm, len, numRe, numIm);
+        denominator.evaluate(dbRe, dbIm, zRe, zIm, len, outRe, outIm);
+
+        for (int k = 0; k < len; ++k)
+        {
+            double dRe = outRe[k], dIm = outIm[k];
+            double inv = 1.0 / (dRe * dRe + dIm * dIm);
+            outRe[k] = (numRe[k] * dRe + numIm[k] * dIm) * inv;
+            outIm[k] = (numIm[k] * dRe - numRe[k] * dIm) * inv;
+        }
+    }
+};
+
+// 1 / (z1³ + z2³ + 1 - 3 z1 z2), as in integrand()
+RationalIntegrand defaultIntegrand()
+{
+    const string num = "1", den = "z1^3 + z2^3 + 1 - 3*z1*z2";
+    Polynomial n, d;
+    string error;
+    parsePolynomial(num, n, error);
+    parsePolynomial(den, d, error);
+    return RationalIntegrand(num, n, den, d);
+}
+
+// Largest relative difference between the compiled default and
+// integrand() on the half-step 16 x 16 grid, whose angles are odd
+// multiples of π/16 and so miss the poles at cube roots of unity
+double defaultIntegrandMismatch()
+{
+    const int R = 16;
+    RationalIntegrand f = defaultIntegrand();
+    AxisTable axis(R, 0.5);
+    double termRe[R], termIm[R], worst = 0.0;
+
+    for (int i = 0; i < R; ++i)
+    {
+        f.evaluateRow(complex<double>(axis.re[i], axis.im[i]), axis, 0, R, termRe, termIm);
+        for (int k = 0; k < R; ++k)
+        {
+            complex<double> reference = integrand((i + 0.5) * 2.0 * PI / R, (k + 0.5) * 2.0 * PI / R);
+            worst = max(worst, abs(complex<double>(termRe[k], termIm[k]) - reference) / abs(reference));
+        }
+    }
+    return worst;
+}
+
+// ===============================
+// Row Kernel
+// ===============================
+// The integrand summed over the columns for one z1, formed in
+// chunks and added into independent lanes; the summation order
+// does not depend on how rows are shared between threads.
+const int ROW_LANES = 8;
+
+complex<double> rowSum(const RationalIntegrand& f, complex<double> z1, const AxisTable& axis)
+{
+    double laneRe[ROW_LANES] = {}, laneIm[ROW_LANES] = {};
+    double termRe[ROW_CHUNK], termIm[ROW_CHUNK];
+
+    for (int start = 0; start < axis.size(); start += ROW_CHUNK)
+    {
+        const int len = min(ROW_CHUNK, axis.size() - start);
+        f.evaluateRow(z1, axis, start, len, termRe, termIm);
+
+        int k = 0;
+        for (; k + ROW_LANES <= len; k += ROW_LANES)
+            for (int l = 0; l < ROW_LANES; ++l)
+            {
+                laneRe[l] += termRe[k + l];
+                laneIm[l] += termIm[k + l];
+            }
+        for (int l = 0; k < len; ++k, ++l)
+        {
+            laneRe[l] += termRe[k];
+            laneIm[l] += termIm[k];
+        }
+    }
+
+    complex<double> sum(0.0, 0.0);
+    for (int l = 0; l < ROW_LANES; ++l)
+        sum += complex<double>(laneRe[l], laneIm[l]);
+    return sum;
+}
+
 // ===============================
 // Numerical Integration on T²
 // ===============================
-complex<double> computeContourIntegral(int resolution)
+// Rows are split statically across threads and each row sum is
+// stored; the rows are then added in order with compensation,
+// so the result is the same for any thread count.
+complex<double> compensatedSum(const vector<complex<double>>& values)
+{
+    complex<double> sum(0.0, 0.0), compensation(0.0, 0.0);
+    for (const auto& v : values)
+    {
+        complex<double> y = v - compensation;
+        complex<double> t = sum + y;
+        compensation = (t - sum) - y;
+        sum = t;
+    }
+    return sum;
+}
+
+complex<double> computeContourIntegral(const RationalIntegrand& f, int resolution, double offset, int threads)
 {
     double dtheta = 2.0 * PI / resolution;
+    AxisTable axis(resolution, offset);
+    vector<complex<double>> rows(resolution);
+
+    parallelRows(threads, resolution, [&](int first, int last)
+    {
+        for (int i = first; i < last; ++i)
+            rows[i] = rowSum(f, complex<double>(axis.re[i], axis.im[i]), axis);
+    });
+
+    return compensatedSum(rows) * dtheta * dtheta;
+}
+
+// ===============================
+// Adaptive Nested Refinement
+// ===============================
+// Trapezoid grids nest when the resolution is multiplied by F:
+// the nodal grid θ = 2πk/R under doubling, the half-step grid
+// θ = (k + 1/2) 2π/R under tripling. Each level evaluates only
+// the points that are new to it, adds them to the running sum
+// and rescales, so every sample is computed exactly once and
+// the total work is that of the final grid.
+//
+// Errors come from successive differences d_L = I_L - I_{L-1}.
+// Integrands analytic on the torus converge geometrically,
+// e(FR) ~ e(R)^F, which gives
+//     |I - I_L| ~ |d_L|^{F+1} / |d_{L-1}|^F.
+// Integrands with singularities on the torus converge like R^{-p};
+// p is read off the last two differences and Richardson gives
+//     I ~ I_L + d_L / (F^p - 1),   |I - I_L| ~ |d_L| / (F^p - 1),
+// the latter a conservative estimate for the extrapolated value.
+// Differences that shrink by less than RICHARDSON_MIN_GAIN give
+// no usable order (a divergent integral, or one not yet in its
+// asymptotic regime) and are reported as they are.
+// Refinement stops once the estimate is below tol max(|I|, 1),
+// or at the first level whose sum is not finite: a sample fell
+// on a singularity of the integrand.
+const double RICHARDSON_MIN_GAIN = 1.25;
+
+struct RefinementLevel
+{
+    int resolution;
+    double points;                            // evaluated so far, all levels
+    complex<double> value;
+    complex<double> extrapolated;
+    double difference;                        // |d_L|, infinite on the first level
+    double estimate;                          // estimate of |I - value|
+    bool finite;                              // false if a sample hit a singularity
+};
+
+vector<RefinementLevel> refineContourIntegral(const RationalIntegrand& f, bool shifted, bool analytic,
+                                              double tolerance, int maxResolution, int threads)
+{
+    const int factor = shifted ? 3 : 2;
+    const double offset = shifted ? 0.5 : 0.0;
+    const int oldFirst = shifted ? 1 : 0;     // index of θ_{k'} of the coarser grid at k = F k' + oldFirst
+
+    vector<RefinementLevel> levels;
     complex<double> sum(0.0, 0.0);
+    double points = 0.0;
+
+    for (int resolution = shifted ? 9 : 8; resolution <= maxResolution; resolution *= factor)
+    {
+        AxisTable axis(resolution, offset);
+        const bool first = levels.empty();
+        AxisTable fresh = first ? axis : axis.without(factor, oldFirst);
+
+        // Rows of the coarser grid only need the new columns
+        vector<complex<double>> rows(resolution);
+        parallelRows(threads, resolution, [&](int firstRow, int lastRow)
+        {
+            for (int i = firstRow; i < lastRow; ++i)
+            {
+                bool oldRow = !first && (i - oldFirst) % factor == 0;
+                rows[i] = rowSum(f, complex<double>(axis.re[i], axis.im[i]), oldRow ? fresh : axis);
+            }
+        });
+        sum += compensatedSum(rows);
+        points = double(resolution) * resolution;
+
+        double dtheta = 2.0 * PI / resolution;
+        RefinementLevel level{ resolution, points, sum * dtheta * dtheta, sum * dtheta * dtheta,
+                               numeric_limits<double>::infinity(), numeric_limits<double>::infinity(),
+                               isfinite(sum.real()) && isfinite(sum.imag()) };
+        if (!level.finite)
+        {
+            levels.push_back(level);
+            break;
+        }
+
+        if (levels.size() >= 2)
+        {
+            const RefinementLevel& prev = levels.back();
+            level.difference = abs(level.value - prev.value);
+            double d1 = prev.difference, d2 = level.difference;
+            if (analytic)
+                level.estimate = (d1 > 0.0) ? pow(d2, factor + 1) / pow(d1, factor) : 0.0;
+            else if (d2 * RICHARDSON_MIN_GAIN < d1)
+            {
+                double gain = d1 / d2;                // F^p
+                level.extrapolated = level.value + (level.value - prev.value) / (gain - 1.0);
+                level.estimate = d2 / (gain - 1.0);
+            }
+            else
+                level.estimate = d2;
+        }
+        else if (levels.size() == 1)
+        {
+            level.difference = abs(level.value - levels.back().value);
+            level.estimate = level.difference;
+        }
+        levels.push_back(level);
+
+        if (level.estimate <= tolerance * max(abs(level.extrapolated), 1.0))
+            break;
+        if (resolution > maxResolution / factor)
+            break;
+    }
+    return levels;
+}
 
-    for (int i = 0; i < resolution; ++i)
+// ===============================
+// Laurent Coefficients by 2D FFT
+// ===============================
+// On the torus |z1| = r1, |z2| = r2 the rational function N / D
+// has the Laurent expansion sum c_{m,n} z1^m z2^n, and the torus
+// integral of N / D dz1 dz2 is (2πi)² c_{-1,-1} = -4π² c_{-1,-1}.
+// The FFT runs on N / D itself, not on the θ-form -z1 z2 N / D
+// that the quadrature uses, so c_{m,n} is the coefficient of
+// z1^m z2^n in N / D, as generating-function diagonals need.
+// Sampling at θ = 2πk/R and taking a 2D FFT gives
+//     ĉ_{m,n} = r1^m r2^n sum_{p,q} c_{m+pR, n+qR} r1^{pR} r2^{qR},
+// so every c_{m,n} with |m|, |n| < R/2 comes out at once, up to
+// aliasing from the coefficients R away. Coefficients are kept
+// in the scaled form ĉ, whose errors are uniform in m and n, and
+// divided by r1^m r2^n only when read.
+//
+// Aliasing is estimated two ways: the largest |ĉ| in the band
+// |m| or |n| >= 3R/8, where an analytic integrand's coefficients
+// have decayed to about the size of what folds in; and the
+// largest change against the FFT of every other sample (R/2)
+// over |m|, |n| < R/8, which bounds the coarser grid's error.
+struct FFTPlan
+{
+    int n;
+    vector<int> reversed;
+    vector<complex<double>> twiddle;          // e^{-2πik/n}, k < n/2
+
+    explicit FFTPlan(int size) : n(size), reversed(size), twiddle(size / 2)
     {
-        for (int j = 0; j < resolution; ++j)
+        int bits = 0;
+        while ((1 << bits) < n) ++bits;
+        for (int k = 0; k < n; ++k)
         {
-            double t1 = i * dtheta;
-            double t2 = j * dtheta;
-            sum += integrand(t1, t2);
+            int r = 0;
+            for (int b = 0; b < bits; ++b)
+                if (k & (1 << b)) r |= 1 << (bits - 1 - b);
+            reversed[k] = r;
         }
+        for (int k = 0; k < n / 2; ++k)
+            twiddle[k] = polar(1.0, -2.0 * PI * k / n);
     }
 
-    return sum * dtheta * dtheta;
+    // In place: a_m <- sum_k a_k e^{-2πikm/n}
+    void forward(complex<double>* a) const
+    {
+        for (int k = 0; k < n; ++k)
+            if (k < reversed[k]) swap(a[k], a[reversed[k]]);
+        for (int len = 2; len <= n; len <<= 1)
+        {
+            int step = n / len;
+            for (int start = 0; start < n; start += len)
+                for (int k = 0; k < len / 2; ++k)
+                {
+                    complex<double> u = a[start + k];
+                    complex<double> v = a[start + k + len / 2] * twiddle[k * step];
+                    a[start + k] = u + v;
+                    a[start + k + len / 2] = u - v;
+                }
+        }
+    }
+};
+
+// Rows, then columns gathered one at a time; divides by size²
+void fft2D(vector<complex<double>>& grid, int size, int threads)
+{
+    FFTPlan plan(size);
+    parallelRows(threads, size, [&](int first, int last)
+    {
+        for (int j = first; j < last; ++j)
+            plan.forward(&grid[size_t(j) * size]);
+    });
+    parallelRows(threads, size, [&](int first, int last)
+    {
+        vector<complex<double>> column(size);
+        double scale = 1.0 / (double(size) * size);
+        for (int k = first; k < last; ++k)
+        {
+            for (int j = 0; j < size; ++j) column[j] = grid[size_t(j) * size + k];
+            plan.forward(column.data());
+            for (int j = 0; j < size; ++j) grid[size_t(j) * size + k] = column[j] * scale;
+        }
+    });
+}
+
+struct LaurentGrid
+{
+    int resolution = 0;
+    double r1 = 1.0, r2 = 1.0;
+    vector<complex<double>> scaled;           // ĉ_{m,n} at (m mod R, n mod R)
+    double aliasing = 0.0;                    // edge-band estimate, in ĉ units
+    double halfGridChange = 0.0;              // R against R/2, in ĉ units
+    bool finite = true;
+
+    complex<double> scaledAt(int m, int n) const
+    {
+        int R = resolution;
+        return scaled[size_t((m % R + R) % R) * R + (n % R + R) % R];
+    }
+
+    // c_{m,n} = ĉ_{m,n} r1^{-m} r2^{-n}
+    complex<double> at(int m, int n) const
+    {
+        return scaledAt(m, n) * pow(r1, -m) * pow(r2, -n);
+    }
+
+    double errorScale(int m, int n) const { return pow(r1, -m) * pow(r2, -n); }
+};
+
+LaurentGrid computeLaurentCoefficients(const RationalIntegrand& f, int resolution,
+                                       double r1, double r2, int threads)
+{
+    LaurentGrid out;
+    out.resolution = resolution;
+    out.r1 = r1;
+    out.r2 = r2;
+
+    AxisTable axis1(resolution, 0.0, r1), axis2(resolution, 0.0, r2);
+    out.scaled.resize(size_t(resolution) * resolution);
+
+    parallelRows(threads, resolution, [&](int first, int last)
+    {
+        double re[ROW_CHUNK], im[ROW_CHUNK];
+        for (int j = first; j < last; ++j)
+        {
+            const complex<double> z1(axis1.re[j], axis1.im[j]);
+            complex<double>* row = &out.scaled[size_t(j) * resolution];
+            for (int start = 0; start < resolution; start += ROW_CHUNK)
+            {
+                const int len = min(ROW_CHUNK, resolution - start);
+                f.evaluateRow(z1, axis2, start, len, re, im, false);
+                for (int k = 0; k < len; ++k) row[start + k] = complex<double>(re[k], im[k]);
+            }
+        }
+    });
+    for (const auto& v : out.scaled)
+        if (!isfinite(v.real()) || !isfinite(v.imag())) out.finite = false;
+    if (!out.finite) return out;
+
+    const int half = resolution / 2;
+    vector<complex<double>> coarse(size_t(half) * half);
+    for (int j = 0; j < half; ++j)
+        for (int k = 0; k < half; ++k)
+            coarse[size_t(j) * half + k] = out.scaled[size_t(2 * j) * resolution + 2 * k];
+
+    fft2D(out.scaled, resolution, threads);
+    fft2D(coarse, half, threads);
+
+    const int edge = 3 * resolution / 8;
+    for (int m = -half; m < half; ++m)
+        for (int n = -half; n < half; ++n)
+            if (abs(m) >= edge || abs(n) >= edge)
+                out.aliasing = max(out.aliasing, abs(out.scaledAt(m, n)));
+
+    const int inner = resolution / 8;
+    for (int m = -inner + 1; m < inner; ++m)
+        for (int n = -inner + 1; n < inner; ++n)
+        {
+            complex<double> c = coarse[size_t((m + half) % half) * half + (n + half) % half];
+            out.halfGridChange = max(out.halfGridChange, abs(out.scaledAt(m, n) - c));
+        }
+    return out;
 }
 
 // ===============================
 // CLI Interface
 // ===============================
+int readThreads()
+{
+    int threads;
+    cout << "Threads (0 = all cores): ";
+    cin >> threads;
+    if (threads <= 0) threads = max(1u, thread::hardware_concurrency());
+    return threads;
+}
+
+// Reads N and D; keeps the current integrand on a parse error
+void readIntegrand(RationalIntegrand& f)
+{
+    string numText, denText;
+    cout << "\nPolynomials in z1, z2 with +, -, *, ^, parentheses and i, e.g. z1^3 + 2i*z1*z2 - 1\n";
+    cout << "Numerator N  : ";
+    cin >> ws;
+    getline(cin, numText);
+    cout << "Denominator D: ";
+    getline(cin, denText);
+
+    Polynomial num, den;
+    string error;
+    if (!parsePolynomial(numText, num, error) || !parsePolynomial(denText, den, error))
+    {
+        cout << "Parse error: " << error << "\n";
+        return;
+    }
+    if (den.terms.empty())
+    {
+        cout << "The denominator is zero.\n";
+        return;
+    }
+    f = RationalIntegrand(numText, num, denText, den);
+}
+
+void runIntegral(const RationalIntegrand& f)
+{
+    int resolution, shifted;
+    cout << "\nEnter angular resolution (e.g. 200, 400, 800): ";
+    cin >> resolution;
+    cout << "Sample grid (0 = theta = k 2pi/R, through z = 1; 1 = shifted half a step): ";
+    cin >> shifted;
+    int threads = readThreads();
+
+    if (!cin || resolution <= 0)
+    {
+        cout << "Invalid resolution.\n";
+        return;
+    }
+
+    cout << "\nComputing integral...\n";
+
+    auto start = chrono::steady_clock::now();
+    complex<double> result = computeContourIntegral(f, resolution, shifted ? 0.5 : 0.0, threads);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << fixed << setprecision(10);
+    cout << "\nApproximate Integral Value:\n";
+    cout << "Real Part      : " << real(result) << "\n";
+    cout << "Imaginary Part : " << imag(result) << "\n";
+    cout << "Magnitude      : " << abs(result) << "\n";
+    cout << setprecision(3) << "(" << double(resolution) * resolution << " points, "
+         << threads << " thread(s), " << seconds << " s)\n";
+}
+
+void runAdaptive(const RationalIntegrand& f)
+{
+    int shifted, model, maxResolution;
+    double tolerance;
+    cout << "\nGrid (0 = theta = k 2pi/R, doubled; 1 = shifted half a step, tripled): ";
+    cin >> shifted;
+    cout << "Convergence (1 = geometric, integrand analytic on the torus; 2 = algebraic, Richardson): ";
+    cin >> model;
+    cout << "Tolerance, relative to max(|I|, 1) (e.g. 1e-10): ";
+    cin >> tolerance;
+    cout << "Largest resolution to try (e.g. 20000): ";
+    cin >> maxResolution;
+    int threads = readThreads();
+
+    if (!cin || !(tolerance > 0.0) || maxResolution < 9)
+    {
+        cout << "Need a positive tolerance and a largest resolution of at least 9.\n";
+        return;
+    }
+
+    auto start = chrono::steady_clock::now();
+    vector<RefinementLevel> levels = refineContourIntegral(f, shifted != 0, model != 2, tolerance,
+                                                           maxResolution, threads);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (!levels.back().finite)
+    {
+        cout << "\nA sample at R = " << levels.back().resolution
+             << " is not finite: the grid passes through a singularity of the integrand.\n"
+             << "Try the shifted grid (1), or move the singularity off |z1| = |z2| = 1.\n";
+        return;
+    }
+
+    cout << "\n" << setw(8) << "R" << setw(24) << "Re I_R" << setw(24) << "Im I_R"
+         << setw(13) << "|d_R|" << setw(13) << "estimate" << "\n";
+    for (const auto& level : levels)
+        cout << setw(8) << level.resolution << fixed << setprecision(15)
+             << setw(24) << real(level.value) << setw(24) << imag(level.value)
+             << scientific << setprecision(2) << setw(13) << level.difference
+             << setw(13) << level.estimate << "\n";
+
+    const RefinementLevel& last = levels.back();
+    bool converged = last.estimate <= tolerance * max(abs(last.extrapolated), 1.0);
+    cout << fixed << setprecision(15)
+         << "\n" << (converged ? "Converged" : "Not converged") << " at R = " << last.resolution << "\n"
+         << "Integral       : " << real(last.extrapolated) << " + " << imag(last.extrapolated) << " i\n"
+         << scientific << setprecision(2)
+         << "Error estimate : " << last.estimate << "\n"
+         << fixed << setprecision(3)
+         << "(" << last.points << " points, each evaluated once; " << threads << " thread(s), "
+         << seconds << " s)\n";
+}
+
+void runLaurent(const RationalIntegrand& f)
+{
+    int resolution, window;
+    double r1, r2;
+    string csv;
+    cout << "\nEnter resolution (rounded up to a power of two, at most 8192): ";
+    cin >> resolution;
+    cout << "Radii r1 r2 (e.g. 0.4 0.4; 1 1 passes through z1 = z2 = 1): ";
+    cin >> r1 >> r2;
+    int threads = readThreads();
+    cout << "Print c_{m,n} for |m|, |n| <= ";
+    cin >> window;
+    cout << "CSV output file for all coefficients (or - for none): ";
+    cin >> csv;
+
+    if (!cin || resolution <= 0 || resolution > 8192 || !(r1 > 0.0) || !(r2 > 0.0) || window < 0)
+    {
+        cout << "Need 0 < resolution <= 8192, positive radii and window >= 0.\n";
+        return;
+    }
+    int size = 8;
+    while (size < resolution) size <<= 1;
+
+    auto start = chrono::steady_clock::now();
+    LaurentGrid grid = computeLaurentCoefficients(f, size, r1, r2, threads);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (!grid.finite)
+    {
+        cout << "\nThe contour passes through a singularity; change r1 or r2.\n";
+        return;
+    }
+
+    cout << fixed << setprecision(3) << "\n" << size << " x " << size << " grid, "
+         << threads << " thread(s), " << seconds << " s\n";
+    cout << scientific << setprecision(3)
+         << "Aliasing estimate      : " << grid.aliasing << " r1^-m r2^-n\n"
+         << "Change against R/2 grid: " << grid.halfGridChange << " r1^-m r2^-n\n";
+
+    complex<double> c00 = grid.at(0, 0), cResidue = grid.at(-1, -1);
+    complex<double> integral = -4.0 * PI * PI * cResidue;
+    cout << setprecision(12)
+         << "c_{0,0}                  = " << real(c00) << " + " << imag(c00) << " i\n"
+         << "c_{-1,-1}                = " << real(cResidue) << " + " << imag(cResidue) << " i\n"
+         << "Torus integral -4π² c_{-1,-1} = " << real(integral) << " + " << imag(integral) << " i\n";
+
+    window = min(window, size / 2 - 1);
+    cout << "\nLaurent coefficients c_{m,n} of (" << f.numeratorText << ") / ("
+         << f.denominatorText << ") above the aliasing estimate, |m|, |n| <= " << window << ":\n";
+    int hidden = 0;
+    for (int m = -window; m <= window; ++m)
+        for (int n = -window; n <= window; ++n)
+        {
+            if (abs(grid.scaledAt(m, n)) <= 10.0 * grid.aliasing)
+            {
+                ++hidden;
+                continue;
+            }
+            complex<double> c = grid.at(m, n);
+            cout << setw(6) << m << setw(6) << n << setw(22) << real(c) << setw(22) << imag(c)
+                 << "   ± " << setprecision(1) << grid.aliasing * grid.errorScale(m, n)
+                 << setprecision(12) << "\n";
+        }
+    cout << "(" << hidden << " more within 10x the estimate)\n";
+
+    if (csv != "-")
+    {
+        ofstream out(csv);
+        out << "m,n,re,im,error\n" << setprecision(17);
+        for (int m = -size / 2; m < size / 2; ++m)
+            for (int n = -size / 2; n < size / 2; ++n)
+            {
+                complex<double> c = grid.at(m, n);
+                out << m << "," << n << "," << real(c) << "," << imag(c) << ","
+                    << grid.aliasing * grid.errorScale(m, n) << "\n";
+            }
+        cout << (out ? "Wrote " : "Could not write ") << csv << "\n";
+    }
+}
+
 void runProgram()
 {
     cout << "\n=============================================\n";
@@ -58,33 +992,39 @@ void runProgram()
     cout << " Numerical Contour Integration on T²\n";
     cout << "=============================================\n";
 
+    RationalIntegrand f = defaultIntegrand();
+    double mismatch = defaultIntegrandMismatch();
+    if (mismatch > 1e-12)
+        cout << "\nWarning: the compiled default integrand differs from integrand() by "
+             << scientific << setprecision(2) << mismatch << " (relative).\n";
+
     while (true)
     {
-        int resolution;
-        cout << "\nEnter angular resolution (e.g. 200, 400, 800): ";
-        cin >> resolution;
+        int mode;
+        cout << "\nIntegrand: (" << f.numeratorText << ") / (" << f.denominatorText << ") dz1 dz2\n";
+        cout << "1) Torus integral   2) Laurent coefficients by 2D FFT   3) Enter integrand\n"
+             << "4) Adaptive torus integral to a tolerance\n> ";
+        cin >> mode;
+        if (!cin)
+            break;
 
-        if (resolution <= 0)
+        if (mode == 3)
         {
-            cout << "Invalid resolution.\n";
+            readIntegrand(f);
             continue;
         }
-
-        cout << "\nComputing integral...\n";
-
-        complex<double> result = computeContourIntegral(resolution);
-
-        cout << fixed << setprecision(10);
-        cout << "\nApproximate Integral Value:\n";
-        cout << "Real Part      : " << real(result) << "\n";
-        cout << "Imaginary Part : " << imag(result) << "\n";
-        cout << "Magnitude      : " << abs(result) << "\n";
+        if (mode == 4)
+            runAdaptive(f);
+        else if (mode == 2)
+            runLaurent(f);
+        else
+            runIntegral(f);
 
         char choice;
         cout << "\nCompute another integral? (y/n): ";
         cin >> choice;
 
-        if (choice != 'y' && choice != 'Y')
+        if (!cin || (choice != 'y' && choice != 'Y'))
             break;
     }
 